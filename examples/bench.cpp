@@ -0,0 +1,366 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include <f5/cord/unicode.hpp>
+#include <f5/stats.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) && __has_include(<linux/perf_event.h>)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define F5_CORD_BENCH_PERF
+#endif
+
+
+/**
+    Microbenchmarks for the hot paths of the strings and views, run over
+    generated ASCII, Latin, CJK and emoji text. Each benchmark is run a
+    number of times after a warm up, and the times and, where the kernel
+    allows it, the hardware counters are written as JSON, one benchmark to
+    a line, so two runs can be compared with `diff`. Built with
+    `F5_CORD_STATS` (as `f5-cord-bench-stats`) the statistics counted
+    during each run are added too.
+
+        f5-cord-bench [--repeat N] [--bytes N] [--filter text]
+ */
+
+
+namespace {
+    using clock = std::chrono::steady_clock;
+
+
+    /// The hardware counters, read as a group so they cover the same run
+    class counters {
+      public:
+        static constexpr std::size_t size = 4u;
+        static constexpr char const *names[size] = {
+                "cycles", "instructions", "branch_misses", "cache_misses"};
+        using values = std::array<std::uint64_t, size>;
+
+#ifdef F5_CORD_BENCH_PERF
+        counters() {
+            std::uint64_t const configs[size] = {
+                    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                    PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+            for (std::size_t c{}; c < size; ++c) {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.size = sizeof(attr);
+                attr.config = configs[c];
+                attr.disabled = c == 0u;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP;
+                auto const fd = static_cast<int>(::syscall(
+                        __NR_perf_event_open, &attr, 0, -1,
+                        c == 0u ? -1 : fds[0], 0));
+                if (fd < 0) {
+                    close();
+                    return;
+                }
+                fds[c] = fd;
+            }
+        }
+        ~counters() { close(); }
+
+        bool available() const noexcept { return fds[size - 1u] >= 0; }
+
+        void start() {
+            if (not available()) return;
+            ::ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ::ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+        values stop() {
+            values v = {};
+            if (not available()) return v;
+            ::ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            std::uint64_t read[1u + size] = {};
+            if (::read(fds[0], read, sizeof(read)) == sizeof(read)) {
+                std::copy(read + 1, read + 1 + size, v.begin());
+            }
+            return v;
+        }
+
+      private:
+        int fds[size] = {-1, -1, -1, -1};
+        void close() {
+            for (auto &fd : fds) {
+                if (fd >= 0) ::close(fd);
+                fd = -1;
+            }
+        }
+#else
+        bool available() const noexcept { return false; }
+        void start() {}
+        values stop() { return {}; }
+#endif
+    };
+
+
+    /// Text made from a small alphabet with spaces and line breaks, using
+    /// a fixed seed so every run sees the same text
+    std::string corpus(
+            std::vector<std::string> const &alphabet, std::size_t const bytes) {
+        std::string s;
+        s.reserve(bytes + 16u);
+        std::uint32_t seed = 0x2545f491u;
+        auto next = [&]() {
+            seed = seed * 1664525u + 1013904223u;
+            return seed >> 8u;
+        };
+        while (s.size() < bytes) {
+            for (auto letters = 2u + next() % 9u; letters; --letters) {
+                s += alphabet[next() % alphabet.size()];
+            }
+            s += next() % 12u ? ' ' : '\n';
+        }
+        return s;
+    }
+    std::vector<std::string>
+            code_points(f5::cord::utf32 const from, f5::cord::utf32 const to) {
+        std::vector<std::string> alphabet;
+        for (auto cp = from; cp < to; ++cp) {
+            auto const [length, units] = f5::cord::u8encode(cp);
+            alphabet.emplace_back(units.data(), length);
+        }
+        return alphabet;
+    }
+
+
+    struct text {
+        char const *name;
+        std::string content;
+        f5::u8string string;
+        std::vector<f5::u8string> words;
+
+        text(char const *n, std::string c)
+        : name{n}, content{std::move(c)}, string{content} {
+            for (auto const word : f5::cord::split(f5::u8view{string}, U' ')) {
+                words.emplace_back(word);
+            }
+        }
+        f5::u8view view() const { return string; }
+    };
+
+
+    struct summary {
+        double min, median, mean, stddev;
+    };
+    summary summarise(std::vector<double> v) {
+        std::sort(v.begin(), v.end());
+        double sum{}, squares{};
+        for (auto const x : v) sum += x;
+        auto const mean = sum / v.size();
+        for (auto const x : v) squares += (x - mean) * (x - mean);
+        return {v.front(), v[v.size() / 2u], mean,
+                std::sqrt(squares / v.size())};
+    }
+
+
+    struct bench {
+        std::size_t repeat = 15u;
+        std::string filter;
+        counters hardware;
+
+        void run(
+                text const &t,
+                char const *const name,
+                std::function<std::size_t()> const &f) {
+            std::string const label = std::string{name} + "/" + t.name;
+            if (label.find(filter) == std::string::npos) return;
+            auto result = f();
+            std::vector<double> ns;
+            std::vector<std::vector<double>> counts(counters::size);
+            auto const before = f5::stats::read();
+            for (std::size_t r{}; r < repeat; ++r) {
+                auto const start = clock::now();
+                hardware.start();
+                result = f();
+                auto const values = hardware.stop();
+                ns.push_back(std::chrono::duration<double, std::nano>(
+                                     clock::now() - start)
+                                     .count());
+                for (std::size_t c{}; c < counters::size; ++c) {
+                    counts[c].push_back(values[c]);
+                }
+            }
+            auto const counted = f5::stats::read() - before;
+            auto const time = summarise(ns);
+            auto const bytes = t.content.size();
+            std::cout << "{\"name\": \"" << name << "\", \"corpus\": \""
+                      << t.name << "\", \"bytes\": " << bytes
+                      << ", \"runs\": " << repeat << ", \"ns\": {\"min\": "
+                      << time.min << ", \"median\": " << time.median
+                      << ", \"mean\": " << time.mean
+                      << ", \"stddev\": " << time.stddev
+                      << "}, \"gb_per_s\": " << bytes / time.median;
+            if (hardware.available()) {
+                for (std::size_t c{}; c < counters::size; ++c) {
+                    std::cout << ", \"" << counters::names[c]
+                              << "\": " << summarise(counts[c]).median;
+                }
+            }
+            if constexpr (f5::stats::enabled) {
+                char const *comma = "";
+                std::cout << ", \"stats\": {";
+                counted.each([&](char const *const stat, std::uint64_t v) {
+                    std::cout << comma << '"' << stat << "\": " << v / repeat;
+                    comma = ", ";
+                });
+                std::cout << '}';
+            }
+            std::cout << ", \"result\": " << result << "}\n";
+        }
+    };
+}
+
+
+int main(int const argc, char const *const argv[]) {
+    bench b;
+    std::size_t bytes = 1u << 20;
+    for (int a{1}; a + 1 < argc; a += 2) {
+        std::string const option{argv[a]};
+        if (option == "--repeat") {
+            b.repeat = std::max(std::strtoul(argv[a + 1], nullptr, 10), 1ul);
+        } else if (option == "--bytes") {
+            bytes = std::strtoul(argv[a + 1], nullptr, 10);
+        } else if (option == "--filter") {
+            b.filter = argv[a + 1];
+        } else {
+            std::cerr << "Unknown option " << option << '\n';
+            return 1;
+        }
+    }
+
+    std::vector<text> texts;
+    texts.emplace_back("ascii", corpus(code_points(U'a', U'z' + 1), bytes));
+    texts.emplace_back(
+            "latin", corpus(code_points(U'\xC0', U'\x17F'), bytes));
+    texts.emplace_back(
+            "cjk", corpus(code_points(U'\x4E00', U'\x4FFF'), bytes));
+    texts.emplace_back(
+            "emoji", corpus(code_points(U'\x1F600', U'\x1F64F'), bytes));
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "{\"benchmark\": \"f5-cord-bench\", \"repeat\": " << b.repeat
+              << ", \"counters\": "
+              << (b.hardware.available() ? "true" : "false") << "}\n";
+
+    for (auto const &t : texts) {
+        auto const view = t.view();
+        auto const &words = t.words;
+        std::string const copy{t.content};
+        f5::u8view const other{copy.data(), copy.size()};
+        std::u16string const wide{f5::u16string{view}};
+        f5::u16view const view16{wide.data(), wide.size()};
+        std::u32string const decoded{f5::u32string{view}};
+        /// Made once so that `encode_into` is timed on its own
+        std::string encoded(4u * decoded.size(), '\0');
+
+        b.run(t, "construct", [&]() {
+            return f5::u8string{t.content}.code_units();
+        });
+        b.run(t, "construct_words", [&]() {
+            std::size_t units{};
+            for (auto const &w : words) {
+                units += f5::u8string{w.data(), w.code_units()}.code_units();
+            }
+            return units;
+        });
+        b.run(t, "copy_destroy", [&]() {
+            std::vector<f5::u8string> const copies{words};
+            return copies.size();
+        });
+        b.run(t, "code_points", [&]() { return view.code_points(); });
+        b.run(t, "iterate", [&]() {
+            std::size_t sum{};
+            for (auto const cp : view) sum += cp;
+            return sum;
+        });
+        b.run(t, "iterate_u16", [&]() {
+            std::size_t sum{};
+            for (auto i = view.u16begin(); i != view.u16end(); ++i) sum += *i;
+            return sum;
+        });
+        b.run(t, "substr", [&]() {
+            auto const length = view.code_points();
+            std::size_t units{};
+            for (std::size_t s{}; s < 8u; ++s) {
+                units += view.substr_pos(
+                                     length * s / 8u, length * (s + 1u) / 8u)
+                                 .code_units();
+            }
+            return units;
+        });
+        b.run(t, "compare", [&]() {
+            return std::size_t(view == other) + std::size_t(view < other);
+        });
+        b.run(t, "compare_words", [&]() {
+            std::size_t less{};
+            for (std::size_t w{1u}; w < words.size(); ++w) {
+                less += words[w - 1u] < words[w];
+            }
+            return less;
+        });
+        b.run(t, "hash", [&]() { return std::size_t(f5::cord::hash(view)); });
+        b.run(t, "hash_words", [&]() {
+            std::size_t h{};
+            for (auto const &w : words) h ^= f5::cord::hash(w);
+            return h;
+        });
+        b.run(t, "concatenate", [&]() {
+            std::size_t units{};
+            for (std::size_t w{1u}; w < words.size(); w += 2u) {
+                units += (words[w - 1u] + words[w]).code_units();
+            }
+            return units;
+        });
+        b.run(t, "valid_length", [&]() {
+            return f5::cord::valid_length(
+                    static_cast<f5::cord::const_u8buffer>(view));
+        });
+        b.run(t, "transcode_u16", [&]() {
+            return f5::cord::transcode<f5::cord::utf16>(view).code_units();
+        });
+        b.run(t, "transcode_u32", [&]() {
+            return f5::cord::transcode<f5::cord::utf32>(view).code_units();
+        });
+        b.run(t, "transcode_u16_u8", [&]() {
+            return f5::cord::transcode<f5::cord::utf8>(view16).code_units();
+        });
+        b.run(t, "encode_into", [&]() {
+            return f5::cord::encode_into(
+                           f5::cord::const_u32buffer{
+                                   decoded.data(), decoded.size()},
+                           f5::cord::u8buffer{
+                                   encoded.data(), encoded.size()})
+                    .second;
+        });
+        b.run(t, "u8encode", [&]() {
+            std::size_t units{};
+            for (auto const cp : decoded) units += f5::cord::u8encode(cp).first;
+            return units;
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include <f5/cord/unicode.hpp>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+
+/**
+    Compares UTF-8 iteration and `substr` on mostly ASCII text against a
+    loop that decodes every code point the way the iterator used to.
+ */
+
+
+namespace {
+    using clock = std::chrono::steady_clock;
+
+    /// Roughly 95% ASCII with some two and three byte code points mixed in
+    std::string corpus(std::size_t const bytes) {
+        char const *const words[] = {
+                "the ",      "quick ",         "brown ", "fox ",
+                "jumps ",    "over ",          "lazy ",  "dogs\n",
+                "caf\xC3\xA9 ", "\xE2\x9C\x93 "};
+        std::string s;
+        s.reserve(bytes + 16);
+        for (std::size_t w{}; s.size() < bytes; w = (w * 7 + 3) % 97) {
+            s += words[w < 94 ? w % 8 : 8 + w % 2];
+        }
+        return s;
+    }
+
+    /// The pre-existing iterator decoded on dereference and again on
+    /// increment
+    struct legacy {
+        f5::cord::const_u8buffer buffer;
+        f5::utf32 operator*() const {
+            return f5::cord::decode_one<std::range_error>(buffer).first;
+        }
+        legacy &operator++() {
+            buffer = buffer.slice(f5::cord::u8length<std::range_error>(**this));
+            return *this;
+        }
+        bool operator!=(legacy const &l) const {
+            return buffer.data() != l.buffer.data();
+        }
+    };
+
+    template<typename F>
+    void time(char const *const name, std::size_t const bytes, F f) {
+        auto best = clock::duration::max();
+        std::size_t result{};
+        for (auto c{5}; c; --c) {
+            auto const start = clock::now();
+            result = f();
+            best = std::min(best, clock::now() - start);
+        }
+        auto const ns =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(best).count();
+        std::cout << "  " << name << " " << ns / 1000 << "μs "
+                  << double(bytes) / ns << "GB/s (" << result << ")\n";
+    }
+}
+
+
+int main() {
+    auto const text = corpus(32u << 20);
+    f5::u8view const view{text.data(), text.size()};
+    auto const half = view.code_points() / 2;
+    std::cout << "UTF-8 iteration over " << text.size() << " bytes\n";
+
+    legacy const lb{f5::cord::const_u8buffer{view}},
+            le{f5::cord::const_u8buffer{view}.slice(text.size())};
+    time("legacy iteration", text.size(), [&]() {
+        std::size_t sum{};
+        for (auto p{lb}; p != le; ++p) sum += *p;
+        return sum;
+    });
+    time("iteration", text.size(), [&]() {
+        std::size_t sum{};
+        for (auto cp : view) sum += cp;
+        return sum;
+    });
+    time("reverse iteration", text.size(), [&]() {
+        std::size_t sum{};
+        for (auto p = view.rbegin(); p != view.rend(); ++p) sum += *p;
+        return sum;
+    });
+    time("legacy substr", text.size() / 2, [&]() {
+        auto p{lb};
+        for (auto s{half}; s && p != le; --s) ++p;
+        return std::size_t(le.buffer.data() - p.buffer.data());
+    });
+    time("substr", text.size() / 2, [&]() {
+        return view.substr(half).code_units();
+    });
+    time("legacy code_points", text.size(), [&]() {
+        std::size_t count{};
+        for (auto p{lb}; p != le; ++p) ++count;
+        return count;
+    });
+    time("code_points", text.size(), [&]() { return view.code_points(); });
+    /// A copy, so the comparison can't stop early on a shared pointer
+    std::string const suffix{view.substr(half)};
+    time("ends_with", suffix.size(), [&]() {
+        return std::size_t(
+                view.ends_with(f5::u8view{suffix.data(), suffix.size()}));
+    });
+
+    return 0;
+}
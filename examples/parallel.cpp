@@ -0,0 +1,105 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include <f5/cord/parallel.hpp>
+#include <f5/cord/unicode.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+
+/**
+    Times the parallel kernels on a large text for one thread and then
+    doubling up to the number of hardware threads, so the scaling can be
+    seen. The single threaded kernel is timed first for comparison.
+ */
+
+
+namespace {
+    using clock = std::chrono::steady_clock;
+    namespace parallel = f5::cord::parallel;
+
+    /// Roughly 95% ASCII with some two and three byte code points mixed in
+    std::string corpus(std::size_t const bytes) {
+        char const *const words[] = {
+                "the ",      "quick ",         "brown ", "fox ",
+                "jumps ",    "over ",          "lazy ",  "dogs\n",
+                "caf\xC3\xA9 ", "\xE2\x9C\x93 "};
+        std::string s;
+        s.reserve(bytes + 16);
+        for (std::size_t w{}; s.size() < bytes; w = (w * 7 + 3) % 97) {
+            s += words[w < 94 ? w % 8 : 8 + w % 2];
+        }
+        return s;
+    }
+
+    template<typename F>
+    void time(char const *const name, std::size_t const bytes, F f) {
+        auto best = clock::duration::max();
+        std::size_t result{};
+        for (auto c{5}; c; --c) {
+            auto const start = clock::now();
+            result = f();
+            best = std::min(best, clock::now() - start);
+        }
+        auto const ns =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(best).count();
+        std::cout << "  " << name << " " << ns / 1000 << "μs "
+                  << double(bytes) / ns << "GB/s (" << result << ")\n";
+    }
+
+    template<typename F>
+    void scale(char const *const name, std::size_t const bytes, F f) {
+        std::size_t const most =
+                std::max(std::thread::hardware_concurrency(), 1u);
+        for (std::size_t threads{1u};; threads *= 2u) {
+            threads = std::min(threads, most);
+            parallel::options options;
+            options.threads = threads;
+            std::string const label =
+                    std::string{name} + " x" + std::to_string(threads);
+            time(label.c_str(), bytes, [&]() { return f(options); });
+            if (threads == most) break;
+        }
+    }
+}
+
+
+int main() {
+    auto const text = corpus(256u << 20);
+    f5::u8view const view{text.data(), text.size()};
+    auto const bytes = text.size();
+    std::cout << "Processing " << bytes << " bytes of UTF-8 on up to "
+              << std::thread::hardware_concurrency() << " threads\n";
+
+    time("valid_length", bytes, [&]() {
+        return f5::cord::valid_length(
+                static_cast<f5::cord::const_u8buffer>(view));
+    });
+    scale("parallel::valid_length", bytes, [&](auto const &o) {
+        return parallel::valid_length(view, o);
+    });
+    time("code_points", bytes, [&]() { return view.code_points(); });
+    scale("parallel::code_points", bytes, [&](auto const &o) {
+        return parallel::code_points(view, o);
+    });
+    time("transcode to UTF-16", bytes, [&]() {
+        return f5::cord::transcode<f5::cord::utf16>(view).code_units();
+    });
+    scale("parallel::transcode to UTF-16", bytes, [&](auto const &o) {
+        return parallel::transcode<f5::cord::utf16>(view, o).code_units();
+    });
+    time("count", bytes, [&]() { return view.count("lazy dogs"); });
+    scale("parallel::find_all", bytes, [&](auto const &o) {
+        return parallel::find_all(view, f5::u8view{"lazy dogs"}, o).size();
+    });
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include <f5/control-pool.hpp>
+#include <f5/cord/unicode.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/**
+    Measures how long it takes to make and release strings that are too long
+    to be stored inline, both with and without `f5::control_pool`.
+
+    * **local** -- each thread makes and releases its own strings.
+    * **handoff** -- half of the threads make batches of strings and pass
+      them to the other half, which release them.
+ */
+
+
+namespace {
+
+
+    using clock = std::chrono::steady_clock;
+    constexpr std::size_t rounds = 200, batch = 1000;
+
+    std::string const text{"A string that is too long to be stored inline"};
+
+    template<typename F>
+    auto time(std::size_t const threads, F f) {
+        auto const started = clock::now();
+        std::vector<std::thread> workers;
+        for (std::size_t t{}; t < threads; ++t) workers.emplace_back(f, t);
+        for (auto &w : workers) w.join();
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                       clock::now() - started)
+                .count();
+    }
+
+
+    void local(std::size_t) {
+        std::vector<f5::u8string> strings;
+        strings.reserve(batch);
+        for (std::size_t r{}; r < rounds; ++r) {
+            for (std::size_t n{}; n < batch; ++n) {
+                strings.emplace_back(text);
+            }
+            strings.clear();
+        }
+    }
+
+
+    /// The producers wait once there are `depth` batches in the queue
+    constexpr std::size_t depth = 4;
+    struct queue {
+        std::mutex mutex;
+        std::condition_variable signal;
+        std::deque<std::vector<f5::u8string>> batches;
+
+        void push(std::vector<f5::u8string> b) {
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                signal.wait(lock, [this]() { return batches.size() < depth; });
+                batches.push_back(std::move(b));
+            }
+            signal.notify_all();
+        }
+        std::vector<f5::u8string> pop() {
+            std::unique_lock<std::mutex> lock{mutex};
+            signal.wait(lock, [this]() { return not batches.empty(); });
+            auto b = std::move(batches.front());
+            batches.pop_front();
+            lock.unlock();
+            signal.notify_all();
+            return b;
+        }
+    };
+
+
+    void handoff(std::size_t const threads) {
+        std::vector<queue> queues(threads / 2u);
+        std::cout << " handoff "
+                  << time(queues.size() * 2u,
+                          [&](std::size_t const t) {
+                              auto &q = queues[t / 2u];
+                              for (std::size_t r{}; r < rounds; ++r) {
+                                  if (t % 2u) {
+                                      q.pop();
+                                  } else {
+                                      std::vector<f5::u8string> b;
+                                      b.reserve(batch);
+                                      for (std::size_t n{}; n < batch; ++n) {
+                                          b.emplace_back(text);
+                                      }
+                                      q.push(std::move(b));
+                                  }
+                              }
+                          })
+                  << "ms";
+    }
+
+
+    void run(char const *const label) {
+        for (std::size_t threads = 2; threads <= 16; threads *= 2) {
+            std::cout << label << " threads " << threads << " local "
+                      << time(threads, local) << "ms";
+            handoff(threads);
+            std::cout << '\n';
+        }
+    }
+
+
+}
+
+
+int main() {
+    run("operator new");
+    f5::control_pool::install();
+    run("control_pool");
+    return 0;
+}
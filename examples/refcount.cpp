@@ -0,0 +1,62 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include <f5/cord/unicode.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+
+/**
+    Measures copying and destroying strings with the atomic (`u8string`)
+    and plain (`u8string_local`) reference counts. The strings are too long
+    to be stored inline, so every copy changes the count.
+ */
+
+
+namespace {
+
+
+    using clock = std::chrono::steady_clock;
+    constexpr std::size_t rounds = 2000, copies = 10000;
+
+    char const *const text = "A string that is too long to be stored inline";
+
+
+    template<typename S>
+    void measure(char const *const label, S const &s) {
+        std::vector<S> strings;
+        strings.reserve(copies);
+        std::size_t total{};
+        auto const started = clock::now();
+        for (std::size_t r{}; r < rounds; ++r) {
+            for (std::size_t n{}; n < copies; ++n) strings.push_back(s);
+            total += strings.size();
+            strings.clear();
+        }
+        auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                clock::now() - started)
+                                .count();
+        std::cout << label << ' ' << total << " copies "
+                  << ns / 1'000'000 << "ms "
+                  << double(ns) / double(total) << "ns per copy\n";
+    }
+
+
+}
+
+
+int main() {
+    measure("u8string      ",
+            f5::u8string{f5::u8view{text, std::strlen(text)}});
+    measure("u8string_local",
+            f5::u8string_local{f5::u8view_local{text, std::strlen(text)}});
+    return 0;
+}
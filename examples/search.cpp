@@ -0,0 +1,125 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include <f5/cord/unicode.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+
+/**
+    Compares the searches on views with the same searches through
+    `std::string_view`. Each needle is either missing or only at the far
+    end of the text, so all of it is scanned.
+ */
+
+
+namespace {
+    using clock = std::chrono::steady_clock;
+
+    /// Roughly 95% ASCII with some two and three byte code points mixed in
+    std::string corpus(std::size_t const bytes) {
+        char const *const words[] = {
+                "the ",      "quick ",         "brown ", "fox ",
+                "jumps ",    "over ",          "lazy ",  "dogs\n",
+                "caf\xC3\xA9 ", "\xE2\x9C\x93 "};
+        std::string s;
+        s.reserve(bytes + 16);
+        for (std::size_t w{}; s.size() < bytes; w = (w * 7 + 3) % 97) {
+            s += words[w < 94 ? w % 8 : 8 + w % 2];
+        }
+        return s;
+    }
+
+    template<typename F>
+    void time(char const *const name, std::size_t const bytes, F f) {
+        auto best = clock::duration::max();
+        std::size_t result{};
+        for (auto c{5}; c; --c) {
+            auto const start = clock::now();
+            result = f();
+            best = std::min(best, clock::now() - start);
+        }
+        auto const ns =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(best).count();
+        std::cout << "  " << name << " " << ns / 1000 << "μs "
+                  << double(bytes) / ns << "GB/s (" << result << ")\n";
+    }
+}
+
+
+int main() {
+    auto const text =
+            corpus(32u << 20) + "#the needle in the haystack\xE2\x98\x83";
+    f5::u8view const view{text.data(), text.size()};
+    std::string_view const sv{text};
+    auto const bytes = text.size();
+    std::cout << "Searching " << bytes << " bytes of UTF-8\n";
+
+    time("std::string_view::find byte", bytes, [&]() {
+        return sv.find('#');
+    });
+    time("find code point", bytes, [&]() { return view.find_offset(U'#'); });
+    time("std::string_view::rfind byte", bytes, [&]() {
+        return sv.rfind('\t');
+    });
+    time("rfind code point", bytes, [&]() {
+        return view.rfind_offset(U'\t');
+    });
+    time("std::count byte", bytes, [&]() {
+        return std::size_t(std::count(sv.begin(), sv.end(), '\n'));
+    });
+    time("count code point", bytes, [&]() { return view.count(U'\n'); });
+    time("std::string_view::find three bytes", bytes, [&]() {
+        return sv.find("\xE2\x98\x83");
+    });
+    time("find three byte code point", bytes, [&]() {
+        return view.find_offset(U'\x2603');
+    });
+    time("std::string_view::find needle", bytes, [&]() {
+        return sv.find("the needle in the haystack");
+    });
+    time("find needle", bytes, [&]() {
+        return view.find_offset("the needle in the haystack");
+    });
+    time("std::string_view::rfind needle", bytes, [&]() {
+        return sv.rfind("lazy dogs\ncaf");
+    });
+    time("rfind needle", bytes, [&]() {
+        return view.rfind_offset("lazy dogs\ncaf");
+    });
+    time("std::string_view::find_first_of", bytes, [&]() {
+        return sv.find_first_of("#@;");
+    });
+    time("find_first_of", bytes, [&]() {
+        return view.find_first_of_offset("#@;");
+    });
+    time("find_first_of with a code point", bytes, [&]() {
+        return view.find_first_of_offset("#@;\xE2\x98\x83");
+    });
+
+    std::u16string const text16{f5::u16string{view}};
+    f5::u16view const view16{text16.data(), text16.size()};
+    std::u16string_view const sv16{text16};
+    std::cout << "Searching " << text16.size() << " code units of UTF-16\n";
+    time("std::u16string_view::find", text16.size() * 2, [&]() {
+        return sv16.find(u'#');
+    });
+    time("find code point", text16.size() * 2, [&]() {
+        return view16.find_offset(U'#');
+    });
+    time("std::u16string_view::find needle", text16.size() * 2, [&]() {
+        return sv16.find(u"the needle in the haystack");
+    });
+    time("find needle", text16.size() * 2, [&]() {
+        return view16.find_offset(u"the needle in the haystack");
+    });
+
+    return 0;
+}
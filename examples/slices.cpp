@@ -0,0 +1,70 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include <f5/cord/unicode.hpp>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+
+/**
+    Takes many substrings by code point from a large document that is
+    mostly not ASCII. This is built with and without
+    `F5_CORD_CODE_POINT_INDEX` to compare walking the code points with
+    using the index.
+ */
+
+
+namespace {
+    using clock = std::chrono::steady_clock;
+
+    /// Russian text with some ASCII punctuation
+    std::string corpus(std::size_t const bytes) {
+        char const *const words[] = {
+                "\xD0\xB1\xD1\x8B\xD1\x81\xD1\x82\xD1\x80\xD0\xB0\xD1\x8F ",
+                "\xD0\xBB\xD0\xB8\xD1\x81\xD0\xB0 ",
+                "\xD0\xBF\xD1\x80\xD1\x8B\xD0\xB3\xD0\xB0\xD0\xB5\xD1\x82, ",
+                "\xD1\x87\xD0\xB5\xD1\x80\xD0\xB5\xD0\xB7 ",
+                "\xD1\x81\xD0\xBE\xD0\xB1\xD0\xB0\xD0\xBA\xD1\x83.\n"};
+        std::string s;
+        s.reserve(bytes + 32);
+        for (std::size_t w{}; s.size() < bytes; w = (w * 7 + 3) % 97) {
+            s += words[w % 5];
+        }
+        return s;
+    }
+}
+
+
+int main() {
+    f5::u8string const document{corpus(16u << 20)};
+    auto const code_points = document.code_points();
+#if defined(F5_CORD_CODE_POINT_INDEX)
+    std::cout << "Indexed";
+#else
+    std::cout << "Walked";
+#endif
+    std::cout << " substrings of " << document.code_units() << " bytes, "
+              << code_points << " code points\n";
+
+    for (std::size_t const count : {1u, 10u, 100u}) {
+        auto const start = clock::now();
+        std::size_t total{}, position{};
+        for (std::size_t c{}; c < count; ++c) {
+            position = (position * 31 + 7919 * (c + 1)) % code_points;
+            total += document.substr_pos(position, position + 40u).code_units();
+        }
+        auto const us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                clock::now() - start)
+                                .count();
+        std::cout << "  " << count << " slices " << us << "μs (" << total
+                  << ")\n";
+    }
+
+    return 0;
+}
@@ -7,6 +7,7 @@
 
 
 #include <f5/cord/iostream.hpp>
+#include <f5/cord/map-file.hpp>
 #include <f5/cord/unicode.hpp>
 #include <chrono>
 #include <filesystem>
@@ -37,6 +38,8 @@ namespace {
         datum<std::pair<std::size_t, std::size_t>> words_letters = {};
         datum<std::vector<V>> words_view = {};
         datum<std::vector<S>> words = {};
+        datum<std::vector<S>> words_copy = {};
+        datum<std::vector<S>> words_owned = {};
     };
     template<class Ch, class Tr>
     inline auto &operator<<(std::basic_ostream<Ch, Tr> &os, clock::duration d) {
@@ -66,23 +69,44 @@ namespace {
            << duration(s.words_view.t);
         os << "\n  words arrray " << s.words.v.size() << " "
            << duration(s.words.t);
+        os << "\n  words copy " << s.words_copy.v.size() << " "
+           << duration(s.words_copy.t);
+        os << "\n  words owned " << s.words_owned.v.size() << " "
+           << duration(s.words_owned.t);
         return os << '\n';
     }
 
     auto count(std::string const &s) { return s.size(); }
     auto count(f5::u8view s) { return s.memory().size(); }
 
-    void
-            emplace(std::vector<std::string_view> &w,
-                    std::string::const_iterator p,
-                    std::string::const_iterator e) {
-        w.emplace_back(&*p, e - p);
+    /// Make a string that has its own copy of the word
+    std::string own(std::string_view v) { return std::string{v}; }
+    f5::u8string own(f5::u8view v) {
+        return f5::u8string{v.data(), v.code_units()};
     }
-    void
-            emplace(std::vector<f5::u8view> &w,
-                    f5::u8string::const_iterator p,
-                    f5::u8string::const_iterator e) {
-        w.emplace_back(p, e);
+
+    void split(std::string const &s, std::vector<std::string_view> &w) {
+        for (auto pos{s.begin()}, end{s.end()}; pos != end;) {
+            auto ends = std::find(pos, end, '\n');
+            w.emplace_back(&*pos, ends - pos);
+            pos = ends;
+            if (pos != end) ++pos;
+        }
+    }
+    void split(f5::u8string const &s, std::vector<f5::u8view> &w) {
+        for (auto const &line : f5::cord::lines(s)) w.push_back(line);
+    }
+
+    /// Make a string for each word
+    std::vector<std::string> strings(
+            std::string const &, std::vector<std::string_view> const &w) {
+        return {w.begin(), w.end()};
+    }
+    std::vector<f5::u8string>
+            strings(f5::u8string const &s, std::vector<f5::u8view> const &) {
+        std::vector<f5::u8string> w;
+        f5::cord::split_to(f5::cord::lines(s), w);
+        return w;
     }
 
     template<typename S, typename V>
@@ -101,16 +125,14 @@ namespace {
 
         std::vector<V> words_view;
         words_view.reserve(s.words_letters.v.first);
-        for (auto pos{s.wordlist.v.begin()}, end{s.wordlist.v.end()};
-             pos != end;) {
-            auto ends = std::find(pos, end, '\n');
-            emplace(words_view, pos, end);
-            pos = ends;
-            if (pos != end) ++pos;
-        }
+        split(s.wordlist.v, words_view);
         s.words_view.save(std::move(words_view));
-        s.words.save(
-                std::vector<S>{s.words_view.v.begin(), s.words_view.v.end()});
+        s.words.save(strings(s.wordlist.v, s.words_view.v));
+        s.words_copy.save(s.words.v);
+        std::vector<S> owned;
+        owned.reserve(s.words_view.v.size());
+        for (auto const &w : s.words_view.v) { owned.push_back(own(w)); }
+        s.words_owned.save(std::move(owned));
 
         return s;
     }
@@ -130,11 +152,28 @@ int main(int const argc, char const *const argv[]) {
             std::cout << file;
             auto const bytes = std::filesystem::file_size(file);
 
+            auto const started = clock::now();
             std::vector<char> wordlist(bytes);
             std::ifstream{file}.read(wordlist.data(), wordlist.size());
+            auto const read_code_points =
+                    f5::u8view{wordlist.data(), wordlist.size()}.code_points();
+            auto const read = clock::now();
             std::cout << " " << wordlist.size() << " bytes\n";
 
+            /// Loading by mapping the file costs page faults not copies
+            auto const mapped = f5::cord::map_file(file);
+            auto const mapped_code_points = mapped.code_points();
+            auto const mapping = clock::now();
+            std::cout << "  read and count " << read_code_points << " "
+                      << (read - started) << "\n  map and count "
+                      << mapped_code_points << " " << (mapping - read)
+                      << "\n";
+
+#if defined(F5_CORD_NO_SSO)
+            std::cout << "f5::u8string (no SSO)"
+#else
             std::cout << "f5::u8string"
+#endif
                       << benchmark<f5::u8string, f5::u8view>(wordlist);
             std::cout << "std::string"
                       << benchmark<std::string, std::string_view>(wordlist);
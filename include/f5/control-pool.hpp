@@ -0,0 +1,222 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/control.hpp>
+
+#include <array>
+#include <mutex>
+#include <utility>
+
+
+namespace f5 {
+
+
+    /// ## `control_pool`
+    /**
+        Pooled memory for the control blocks made by `control<T>::make_array`
+        (and so for the strings in `f5::cord`). It is opt-in, call `install`
+        to start using it.
+
+        Each thread keeps a free list for each size class. When a thread's
+        list grows past `thread_limit` half of it is moved to a global
+        list, from where other threads can take it when theirs are empty.
+        The global lists are limited to `global_limit` blocks, past which
+        memory is handed back to the global `operator delete`.
+
+        Blocks can be freed on any thread: they join the free list of the
+        thread that frees them. This means that memory moves from threads
+        that free more than they allocate to the others through the global
+        lists.
+     */
+    struct control_pool {
+        /// The size classes are powers of two starting at `smallest`.
+        /// Anything larger than the biggest class isn't pooled.
+        static constexpr std::size_t smallest = 64u, classes = 6u;
+        /// The most blocks a thread keeps for each size class
+        static constexpr std::size_t thread_limit = 256u;
+        /// The most blocks kept globally for each size class
+        static constexpr std::size_t global_limit = 4096u;
+
+        /// Start and stop using the pool for new control blocks. Blocks
+        /// that already exist are always released to where they came from.
+        static void install() noexcept { control_memory::allocator = &allocate; }
+        static void uninstall() noexcept { control_memory::allocator = nullptr; }
+
+        /// Return memory for a control block of `bytes` size along with how
+        /// it is to be released
+        static control_memory::allocation allocate(std::size_t bytes);
+
+        static constexpr std::size_t size_class(std::size_t const bytes) noexcept {
+            std::size_t c{};
+            while (c < classes && (smallest << c) < bytes) ++c;
+            return c;
+        }
+
+      private:
+        /// Free blocks are kept in singly linked lists. The global lists
+        /// are stacks of batches so that moving a batch to or from them is
+        /// a constant time operation while holding the lock.
+        struct node {
+            node *next;
+            node *next_batch;
+            std::size_t count;
+        };
+        static_assert(sizeof(node) <= smallest);
+        struct list {
+            node *head = nullptr;
+            std::size_t count = {};
+
+            void push(node *const n) noexcept {
+                n->next = head;
+                head = n;
+                ++count;
+            }
+            node *pop() noexcept {
+                auto const n = head;
+                head = n->next;
+                --count;
+                return n;
+            }
+            /// Remove up to `n` blocks from the front as a batch
+            node *batch(std::size_t const n) noexcept {
+                if (not head) return nullptr;
+                auto const first = head;
+                node *last = nullptr;
+                std::size_t taken{};
+                for (; taken < n && head; ++taken) {
+                    last = head;
+                    head = head->next;
+                }
+                last->next = nullptr;
+                count -= taken;
+                first->count = taken;
+                return first;
+            }
+            /// Replace the list with a batch
+            void take(node *const b) noexcept {
+                head = b;
+                count = b ? b->count : 0u;
+            }
+            static void release(node *n) noexcept {
+                while (n) {
+                    auto const next = n->next;
+                    ::operator delete(n);
+                    n = next;
+                }
+            }
+        };
+
+        /// The global lists are never destroyed so that blocks can still be
+        /// released while the program is shutting down
+        struct spillover {
+            std::mutex mutex;
+            node *batches = nullptr;
+            std::size_t count = {};
+        };
+        static std::array<spillover, classes> &global() noexcept {
+            static auto *const g = new std::array<spillover, classes>{};
+            return *g;
+        }
+
+        /// Move `n` blocks from a thread's list to the global one
+        static void spill(std::size_t const c, list &from, std::size_t const n) noexcept {
+            auto b = from.batch(n);
+            if (not b) return;
+            {
+                auto &g = global()[c];
+                std::lock_guard<std::mutex> lock{g.mutex};
+                if (g.count + b->count <= global_limit) {
+                    g.count += b->count;
+                    b->next_batch = std::exchange(g.batches, b);
+                    b = nullptr;
+                }
+            }
+            list::release(b);
+        }
+        /// Take a batch from the global list
+        static node *unspill(std::size_t const c) noexcept {
+            auto &g = global()[c];
+            std::lock_guard<std::mutex> lock{g.mutex};
+            auto const b = g.batches;
+            if (b) {
+                g.batches = b->next_batch;
+                g.count -= b->count;
+            }
+            return b;
+        }
+
+        struct cache {
+            std::array<list, classes> lists;
+            ~cache() {
+                for (std::size_t c{}; c < classes; ++c) {
+                    while (lists[c].head) spill(c, lists[c], thread_limit / 2u);
+                }
+                finished() = true;
+            }
+        };
+        static bool &finished() noexcept {
+            static thread_local bool f = false;
+            return f;
+        }
+        /// The current thread's free lists, or `nullptr` if the thread is
+        /// exiting and they are already gone
+        static cache *local() noexcept {
+            if (finished()) return nullptr;
+            static thread_local cache c;
+            return &c;
+        }
+
+        static void *take(std::size_t const c) {
+            if (auto const l = local()) {
+                auto &mine = l->lists[c];
+                if (not mine.head) mine.take(unspill(c));
+                if (mine.head) return mine.pop();
+            }
+            return ::operator new(smallest << c);
+        }
+
+        template<std::size_t C>
+        static void release(void *const block) noexcept {
+            auto const n = new (block) node{};
+            if (auto const l = local()) {
+                auto &mine = l->lists[C];
+                mine.push(n);
+                if (mine.count > thread_limit) {
+                    spill(C, mine, thread_limit / 2u);
+                }
+            } else {
+                list one;
+                one.push(n);
+                spill(C, one, 1u);
+            }
+        }
+        template<std::size_t... C>
+        static constexpr std::array<control_memory::destroy_function, classes>
+                make_releasers(std::index_sequence<C...>) noexcept {
+            return {{&release<C>...}};
+        }
+    };
+
+
+    inline control_memory::allocation
+            control_pool::allocate(std::size_t const bytes) {
+        auto const c = size_class(bytes);
+        if (c < classes) {
+            static constexpr auto releasers =
+                    make_releasers(std::make_index_sequence<classes>{});
+            return {take(c), releasers[c]};
+        } else {
+            return {::operator new(bytes), nullptr};
+        }
+    }
+
+
+}
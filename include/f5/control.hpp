@@ -9,9 +9,13 @@
 #pragma once
 
 
+#include <f5/stats.hpp>
+
 #include <atomic>
 #include <iterator>
 #include <memory>
+#include <new>
+#include <type_traits>
 
 #ifndef assert
 #include <cassert>
@@ -21,34 +25,105 @@
 namespace f5 {
 
 
+    /// ## Reference counting
+    /**
+        The ownership count of a control block. `atomic_count` lets the
+        strings that share a block be used from any thread. `plain_count`
+        is cheaper to change, but the block and everything that refers to
+        it must then stay on a single thread.
+     */
+    using atomic_count = std::atomic<std::size_t>;
+    using plain_count = std::size_t;
+
+
     /// ## `control`
     /**
         Control block for owned memory.
      */
-    template<typename T = void>
+    template<typename T = void, typename R = atomic_count>
     struct control;
 
 
+    /**
+        The memory for control blocks, shared by all of the counting
+        policies.
+     */
+    struct control_memory {
+        /// Used to release a control block when its count reaches zero
+        using destroy_function = void (*)(void *) noexcept;
+
+        /**
+            When set, the memory for the blocks made by `make_array` comes
+            from here instead of the global `operator new`. The function is
+            given the number of bytes needed and returns the memory along
+            with the function the block is to be destroyed with. Each block
+            remembers how it is to be released, so this can be changed at
+            any time. See [control-pool.hpp](./control-pool.hpp).
+         */
+        using allocation = std::pair<void *, destroy_function>;
+        using allocate_function = allocation (*)(std::size_t);
+        static inline std::atomic<allocate_function> allocator{nullptr};
+
+      protected:
+        static allocation allocate(std::size_t const bytes) {
+            if (auto const a = allocator.load(std::memory_order_relaxed)) {
+                return a(bytes);
+            } else {
+                return {::operator new(bytes), nullptr};
+            }
+        }
+
+        /// The allocation size for a control block of type `B` followed by
+        /// `count` items of `C`, and where those items start
+        template<typename B, typename C>
+        static constexpr std::size_t array_offset() noexcept {
+            static_assert(
+                    alignof(C) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                    "The array can't be over-aligned");
+            return (sizeof(B) + alignof(C) - 1u) / alignof(C) * alignof(C);
+        }
+    };
+
+
     /**
         For the `void` superclass we don't store any extra information in
         the control block for the client code.
+
+        There is no virtual destructor. Control blocks that own some other
+        object record how to destroy themselves in `destroy`. Those made by
+        `make_array` have their data directly after them in the same
+        allocation and leave `destroy` as `nullptr`, so releasing them is
+        just a deallocation.
      */
-    template<>
-    struct control<void> {
-        /// Use a virtual destructor for type erasure
-        virtual ~control() = default;
+    template<typename R>
+    struct control<void, R> : public control_memory {
+        control(destroy_function d = nullptr) noexcept : destroy{d} {
+            stats::record(stats::counter::control_blocks_created);
+        }
+        control(control const &) = delete;
+        control &operator=(control const &) = delete;
+
+        /// `std::unique_ptr` deleter that releases the initial ownership
+        struct deleter {
+            void operator()(control *c) const noexcept { decrement(c); }
+        };
 
         /**
             Creates a new control block with an ownership count of 1.
          */
         template<typename S>
-        static std::pair<std::unique_ptr<control<void>>, S *> make(S &&s) {
-            struct sub : public control<void> {
+        static std::pair<std::unique_ptr<control, deleter>, S *> make(S &&s) {
+            struct sub : public control {
                 S item;
-                sub(S &&s) : item{std::move(s)} {}
+                sub(S &&s)
+                : control{[](void *c) noexcept {
+                      delete static_cast<sub *>(static_cast<control *>(c));
+                  }},
+                  item{std::move(s)} {}
             };
-            auto made = std::make_unique<sub>(std::move(s));
-            return {std::move(made), &made->item};
+            std::unique_ptr<control, deleter> made{new sub{std::move(s)}};
+            made->allocated(sizeof(sub));
+            return {std::move(made), &static_cast<sub *>(made.get())->item};
         }
 
         /**
@@ -59,15 +134,59 @@ namespace f5 {
            that point (which in turn will destruct the owned memory.
          */
         static control *increment(control *c) noexcept {
-            if (c) ++c->ownership_count;
+            if (c) {
+                ++c->ownership_count;
+                stats::record(stats::counter::increments);
+            }
+            return c;
+        }
+        /// Add `n` owners at once, so that many new owners cost a single
+        /// change to the count
+        static control *increment(control *c, std::size_t const n) noexcept {
+            if (c && n) {
+                c->ownership_count += n;
+                stats::record(stats::counter::increments);
+            }
             return c;
         }
         static void decrement(control *c) noexcept {
-            if (c && --c->ownership_count == 0u) { delete c; }
+            if (c) stats::record(stats::counter::decrements);
+            if (c && --c->ownership_count == 0u) {
+                stats::record(stats::counter::control_blocks_destroyed);
+#if defined(F5_CORD_STATS)
+                stats::record(
+                        stats::counter::bytes_released, c->allocated_bytes);
+#endif
+                if (c->destroy) {
+                    c->destroy(c);
+                } else {
+                    ::operator delete(c);
+                }
+            }
+        }
+
+        /// The number of owners. With `atomic_count` this can change as
+        /// soon as it has been read unless the caller knows that no other
+        /// thread can be adding or removing owners.
+        static std::size_t owners(control const *c) noexcept {
+            return c ? std::size_t(c->ownership_count) : 0u;
+        }
+
+      protected:
+        /// Record the size of the block's allocation in the statistics
+        void allocated([[maybe_unused]] std::size_t const bytes) noexcept {
+#if defined(F5_CORD_STATS)
+            allocated_bytes = bytes;
+            stats::record(stats::counter::bytes_allocated, bytes);
+#endif
         }
 
       private:
-        std::atomic<std::size_t> ownership_count = 1u;
+        R ownership_count = 1u;
+        destroy_function destroy;
+#if defined(F5_CORD_STATS)
+        std::size_t allocated_bytes = 0u;
+#endif
     };
 
 
@@ -75,31 +194,109 @@ namespace f5 {
         If client code needs to store extra information in the control block
         then this type can be used.
      */
-    template<typename T>
-    struct control : private control<void> {
+    template<typename T, typename R>
+    struct control : private control<void, R> {
+        using typename control<void, R>::destroy_function;
+
         T user_data;
-        control(T t) : user_data{std::move(t)} {}
+        control(T t, destroy_function d = nullptr)
+        : control<void, R>{d}, user_data{std::move(t)} {}
 
         static control *increment(control *c) noexcept {
-            control<void>::increment(c);
+            control<void, R>::increment(c);
+            return c;
+        }
+        static control *increment(control *c, std::size_t const n) noexcept {
+            control<void, R>::increment(c, n);
             return c;
         }
         static void decrement(control *c) noexcept {
-            control<void>::decrement(c);
+            control<void, R>::decrement(c);
+        }
+        static std::size_t owners(control const *c) noexcept {
+            return control<void, R>::owners(c);
         }
 
+        struct deleter {
+            void operator()(control *c) const noexcept { decrement(c); }
+        };
+
         /**
             Creates a new control block with an ownership count of 1.
          */
         template<typename S>
-        static std::pair<std::unique_ptr<control<T>>, S *> make(S &&s, T t) {
-            struct sub : public control<T> {
+        static std::pair<std::unique_ptr<control, deleter>, S *>
+                make(S &&s, T t) {
+            struct sub : public control {
                 S item;
                 sub(S &&s, T t)
-                : control<T>{std::move(t)}, item{std::move(s)} {}
+                : control{std::move(t),
+                          [](void *c) noexcept {
+                              delete static_cast<sub *>(static_cast<control *>(
+                                      static_cast<control<void, R> *>(c)));
+                          }},
+                  item{std::move(s)} {}
             };
-            auto made = std::make_unique<sub>(std::move(s), std::move(t));
-            return {std::move(made), &made->item};
+            std::unique_ptr<control, deleter> made{
+                    new sub{std::move(s), std::move(t)}};
+            made->allocated(sizeof(sub));
+            return {std::move(made), &static_cast<sub *>(made.get())->item};
+        }
+
+        /**
+            Creates a new control block with an ownership count of 1 and
+            space for `count` items of `C` directly after it, in a single
+            allocation. Returns the control block and the start of the
+            (uninitialised) array. No destructors are run for the array, so
+            `C` must be trivially destructible. If `T` is trivially
+            destructible then releasing the block is just a deallocation,
+            otherwise the block also remembers how to free the memory
+            once `user_data` has been destroyed.
+         */
+        template<typename C>
+        static std::pair<std::unique_ptr<control, deleter>, C *>
+                make_array(std::size_t const count, T t) {
+            static_assert(std::is_trivially_destructible_v<C>);
+            if constexpr (std::is_trivially_destructible_v<T>) {
+                constexpr auto offset =
+                        control_memory::array_offset<control, C>();
+                auto const [memory, destroy] =
+                        control_memory::allocate(offset + count * sizeof(C));
+                std::unique_ptr<control, deleter> made{
+                        new (memory) control{std::move(t), destroy}};
+                made->allocated(offset + count * sizeof(C));
+                return {std::move(made),
+                        reinterpret_cast<C *>(
+                                static_cast<unsigned char *>(memory) + offset)};
+            } else {
+                struct block : public control {
+                    destroy_function release;
+                    block(T t, destroy_function r)
+                    : control{std::move(t), free}, release{r} {}
+                    static void free(void *c) noexcept {
+                        auto const b = static_cast<block *>(
+                                static_cast<control *>(
+                                        static_cast<control<void, R> *>(c)));
+                        auto const release = b->release;
+                        b->~block();
+                        if (release) {
+                            release(b);
+                        } else {
+                            ::operator delete(b);
+                        }
+                    }
+                };
+                constexpr auto offset =
+                        control_memory::array_offset<block, C>();
+                auto const [memory, release] =
+                        control_memory::allocate(offset + count * sizeof(C));
+                std::unique_ptr<control, deleter> made{
+                        new (memory) block{std::move(t), release}};
+                made->allocated(offset + count * sizeof(C));
+                return {std::move(made),
+                        reinterpret_cast<C *>(
+                                static_cast<unsigned char *>(memory) + offset)};
+            }
         }
     };
 
@@ -140,6 +337,15 @@ namespace f5 {
             iterator++;
             return ret;
         }
+        constexpr owner_tracking_iterator &operator--() {
+            --iterator;
+            return *this;
+        }
+        constexpr owner_tracking_iterator operator--(int) {
+            auto ret = *this;
+            iterator--;
+            return ret;
+        }
         constexpr bool operator==(owner_tracking_iterator i) const noexcept {
             assert(owner == i.owner);
             return iterator == i.iterator;
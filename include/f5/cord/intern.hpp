@@ -0,0 +1,221 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/cord/unicode-hash.hpp>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+namespace f5 {
+
+
+    namespace cord {
+
+
+        /// ## `intern_pool`
+        /**
+            Maps strings to a single canonical `u8string` for each distinct
+            value, along with a dense 32 bit id. Two strings interned in the
+            same pool are equal exactly when their ids are, and interned
+            strings share the pool's control block for that value, so
+            keeping many copies costs no more memory.
+
+            The pool is split into shards by hash, each with its own lock,
+            so threads interning different strings rarely wait for each
+            other. Looking up the string for an id takes no lock, so
+            `string` must not be called while another thread is sweeping.
+
+            Entries stay in the pool until `sweep` is called, which removes
+            those that nothing outside of the pool is using and makes their
+            ids available again. Every entry has an allocation of its own,
+            even when it is short enough to be inline, so that the strings
+            returned by `intern` share it and its ownership count shows
+            whether they are still held. Holding just an id doesn't keep
+            an entry, and nor does a short string made from a view of one,
+            as that is copied inline. Once a pool is swept an id is only
+            valid while a string for it is still held.
+         */
+        class intern_pool {
+          public:
+            using id_type = std::uint32_t;
+
+          private:
+            using control_type = u8view::control_type;
+
+            /// Entries are kept in segments that never move, so the
+            /// `std::string_view` keys in the shards, and the strings
+            /// returned by `string`, stay valid. Segment `k` holds
+            /// `first_segment << k` entries.
+            static constexpr std::size_t first_segment = 1024u,
+                                         segment_count = 23u;
+            std::array<std::atomic<u8string *>, segment_count> segments = {};
+
+            static std::pair<std::size_t, std::size_t>
+                    position(id_type const id) noexcept {
+                auto const k = simd::highest(id / first_segment + 1u);
+                return {k, id - first_segment * ((std::size_t{1} << k) - 1u)};
+            }
+            u8string &entry(id_type const id) const noexcept {
+                auto const [k, offset] = position(id);
+                return segments[k].load(std::memory_order_acquire)[offset];
+            }
+
+            /// Id allocation. Swept ids are used again first so that the
+            /// ids stay dense.
+            std::mutex id_mutex;
+            std::size_t next_id = {};
+            std::vector<id_type> free_ids;
+            std::atomic<std::size_t> live = {};
+
+            id_type allocate_id() {
+                std::lock_guard<std::mutex> lock{id_mutex};
+                if (not free_ids.empty()) {
+                    auto const id = free_ids.back();
+                    free_ids.pop_back();
+                    return id;
+                }
+                if (next_id > std::numeric_limits<id_type>::max()) {
+                    raise<std::length_error>("The intern pool is full");
+                }
+                auto const id = static_cast<id_type>(next_id++);
+                auto const [k, offset] = position(id);
+                if (offset == 0u) {
+                    segments[k].store(
+                            new u8string[first_segment << k],
+                            std::memory_order_release);
+                }
+                return id;
+            }
+
+            struct hasher {
+                std::size_t operator()(std::string_view const s) const noexcept {
+                    return detail::hash_bytes(s.data(), s.size());
+                }
+            };
+            struct shard {
+                std::mutex mutex;
+                std::unordered_map<std::string_view, id_type, hasher> ids;
+            };
+            static constexpr std::size_t shard_count = 64u;
+            std::array<shard, shard_count> shards;
+
+            shard &shard_for(u8view const v) noexcept {
+                /// The low bits are used by the map so take the high ones
+                auto const h = hash(v);
+                return shards[(h >> 32u) % shard_count];
+            }
+
+            /// Find or add the string and pass its id and entry to `f`
+            /// while the shard is still locked, so it can't be swept first
+            template<typename F>
+            auto add(u8view const v, F f) {
+                auto &s = shard_for(v);
+                std::lock_guard<std::mutex> lock{s.mutex};
+                if (auto const found = s.ids.find(v); found != s.ids.end()) {
+                    return f(found->second, entry(found->second));
+                }
+                auto const id = allocate_id();
+                /// Always copy so the pool never keeps alive a larger
+                /// allocation that the view was part of
+                auto &e = entry(id);
+                e = u8string::shared_copy(v);
+                s.ids.emplace(std::string_view{e}, id);
+                ++live;
+                return f(id, e);
+            }
+
+          public:
+            intern_pool() {}
+            intern_pool(intern_pool const &) = delete;
+            intern_pool &operator=(intern_pool const &) = delete;
+            ~intern_pool() {
+                for (auto &s : segments) delete[] s.load();
+            }
+
+
+            /// ## Interning
+
+            /// Return the id for the string, adding it if it isn't
+            /// already in the pool
+            id_type id(u8view const v) {
+                return add(v, [](id_type const id, u8string const &) {
+                    return id;
+                });
+            }
+            /// Return the canonical string, adding it to the pool if
+            /// needed
+            u8string intern(u8view const v) {
+                return add(v, [](id_type, u8string const &e) { return e; });
+            }
+
+            /// Return the id for the string if it is in the pool
+            std::optional<id_type> find(u8view const v) {
+                auto &s = shard_for(v);
+                std::lock_guard<std::mutex> lock{s.mutex};
+                if (auto const found = s.ids.find(v); found != s.ids.end()) {
+                    return found->second;
+                } else {
+                    return {};
+                }
+            }
+
+            /// The canonical string for an id. The reference is only
+            /// valid until the next `sweep`, and this must not be called
+            /// while one is running.
+            u8string const &string(id_type const id) const noexcept {
+                return entry(id);
+            }
+
+            /// The number of strings in the pool
+            std::size_t size() const noexcept { return live.load(); }
+
+
+            /// ## Sweeping
+
+            /// Remove the entries that are only referenced by the pool,
+            /// returning how many were removed. Strings for ids may not be
+            /// looked up with `string` while this runs.
+            std::size_t sweep() {
+                std::vector<id_type> swept;
+                for (auto &s : shards) {
+                    std::lock_guard<std::mutex> lock{s.mutex};
+                    for (auto pos = s.ids.begin(); pos != s.ids.end();) {
+                        auto &e = entry(pos->second);
+                        if (control_type::owners(e.control_block()) == 1u) {
+                            swept.push_back(pos->second);
+                            pos = s.ids.erase(pos);
+                            e = u8string{};
+                        } else {
+                            ++pos;
+                        }
+                    }
+                }
+                live -= swept.size();
+                std::lock_guard<std::mutex> lock{id_mutex};
+                free_ids.insert(free_ids.end(), swept.begin(), swept.end());
+                return swept.size();
+            }
+        };
+
+
+    }
+
+
+}
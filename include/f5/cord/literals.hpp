@@ -0,0 +1,55 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/cord/lstring.hpp>
+#include <f5/cord/unicode-transcode.hpp>
+
+#include <type_traits>
+
+
+namespace f5 {
+
+
+    inline namespace literals {
+
+
+        /// The string literal operator template is a GNU extension, so it
+        /// needs `-Wpedantic` silenced. The diagnostic state is restored
+        /// afterwards so none of this reaches the code including the header.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wgnu-string-literal-operator-template"
+#endif
+        /// Transcode a `u""` or `U""` literal to UTF-8 at compile time. The
+        /// result lives in static storage so strings and views made from it
+        /// have no control block, just like `char` literals. Unpaired
+        /// surrogates and invalid code points are a compile error.
+        template<typename C, C... Text>
+        constexpr inline cord::lstring operator"" _u8() {
+            static_assert(
+                    std::is_same_v<C, char16_t> || std::is_same_v<C, char32_t>,
+                    "Only UTF-16 and UTF-32 literals can be used with _u8");
+            using literal = cord::detail::u8literal<C, Text...>;
+            static_assert(
+                    literal::valid,
+                    "The literal has an unpaired surrogate or invalid code "
+                    "point");
+            return cord::lstring{
+                    cord::detail::u8literal_storage<literal>::bytes};
+        }
+#pragma GCC diagnostic pop
+
+
+    }
+
+
+}
@@ -0,0 +1,190 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/cord/unicode-string.hpp>
+
+#include <cerrno>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace f5 {
+
+
+    namespace cord {
+
+
+        /// ## Memory mapped files
+
+        /// How the mapped file is expected to be read. This is passed on to
+        /// `madvise` and controls how much the kernel reads ahead.
+        enum class map_access {
+            normal,
+            /// Read ahead aggressively and drop pages once they're read
+            sequential,
+            /// Don't read ahead
+            random,
+            /// Start reading the whole file in the background straight away
+            will_need
+        };
+
+        struct map_options {
+            map_access access = map_access::sequential;
+            /// Fault the whole file in when it is mapped (`MAP_POPULATE`),
+            /// so later reads never wait on the disk
+            bool populate = false;
+            /// Ask for the mapping to use huge pages. This is only a hint,
+            /// and needs a kernel that supports it for file mappings.
+            bool huge_pages = false;
+        };
+
+
+        namespace detail {
+
+
+            /// Owns a read only mapping of a file. Held in a string's
+            /// control block, so the mapping goes when the last string
+            /// using it does.
+            struct file_mapping {
+                void *address;
+                std::size_t size;
+
+                file_mapping(void *a, std::size_t s) noexcept
+                : address{a}, size{s} {}
+                file_mapping(file_mapping &&m) noexcept
+                : address{std::exchange(m.address, nullptr)}, size{m.size} {}
+                file_mapping(file_mapping const &) = delete;
+                file_mapping &operator=(file_mapping const &) = delete;
+                ~file_mapping() {
+                    if (address) ::munmap(address, size);
+                }
+            };
+
+            [[noreturn]] inline void
+                    raise_mapping_error(char const *const what) {
+                throw std::system_error{errno, std::system_category(), what};
+            }
+
+            inline int map_advice(map_access const a) noexcept {
+                switch (a) {
+                case map_access::normal: return MADV_NORMAL;
+                case map_access::sequential: return MADV_SEQUENTIAL;
+                case map_access::random: return MADV_RANDOM;
+                case map_access::will_need: return MADV_WILLNEED;
+                }
+                return MADV_NORMAL;
+            }
+
+
+        }
+
+
+        /**
+            Return the content of a file as a `u8string` that reads
+            straight from a private, read only `mmap` of it. Nothing is
+            copied, so loading the file costs only the page faults as it is
+            read. Substrings and views of the string share the mapping,
+            which stays until the last of them is gone. The mapping is
+            always followed by a NUL, so `shrink_to_fit` on the whole file
+            doesn't copy it.
+
+            The content isn't checked. Construct a string from the result
+            with `f5::cord::checked` to validate it (this shares the
+            mapping too).
+
+            The file must not be truncated while it is mapped, and changes
+            made to it by other processes may or may not show up in the
+            string. Files short enough to be stored inline are copied and
+            the mapping released straight away.
+
+            Errors from the operating system are raised as
+            `std::system_error`.
+         */
+        inline u8string map_file(
+                std::filesystem::path const &path,
+                map_options const options = {}) {
+            using control_type = u8view::control_type;
+
+            int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) { detail::raise_mapping_error("Opening the file"); }
+            struct ::stat st;
+            if (::fstat(fd, &st) != 0) {
+                auto const error = errno;
+                ::close(fd);
+                errno = error;
+                detail::raise_mapping_error("Reading the file size");
+            }
+            std::size_t const size = st.st_size;
+            if (size == 0u) {
+                ::close(fd);
+                return {};
+            }
+
+            int flags = MAP_PRIVATE;
+#if defined(MAP_POPULATE)
+            if (options.populate) { flags |= MAP_POPULATE; }
+#endif
+            /// The rest of the last page is filled with zeros, so the
+            /// string is NUL terminated. A file ending exactly on a page
+            /// boundary gets an extra page of zeros mapped after it, so
+            /// this is always true and the control block can record the
+            /// size like any other string's.
+            auto const page =
+                    static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            std::size_t const length = size % page ? size : size + page;
+            void *address = ::mmap(
+                    nullptr, length, PROT_READ,
+                    length == size ? flags : MAP_PRIVATE | MAP_ANONYMOUS,
+                    length == size ? fd : -1, 0);
+            if (address != MAP_FAILED && length != size) {
+                void *const zeros = address;
+                address = ::mmap(
+                        zeros, size, PROT_READ, flags | MAP_FIXED, fd, 0);
+                if (address == MAP_FAILED) {
+                    auto const error = errno;
+                    ::munmap(zeros, length);
+                    errno = error;
+                }
+            }
+            auto const error = errno;
+            /// The mapping keeps its own reference to the file
+            ::close(fd);
+            if (address == MAP_FAILED) {
+                errno = error;
+                detail::raise_mapping_error("Mapping the file");
+            }
+            detail::file_mapping mapping{address, length};
+
+            /// Advice is only a hint, so failures are ignored
+            ::madvise(address, size, detail::map_advice(options.access));
+#if defined(MADV_HUGEPAGE)
+            if (options.huge_pages) {
+                ::madvise(address, size, MADV_HUGEPAGE);
+            }
+#endif
+
+            auto const data = static_cast<char const *>(address);
+            auto made = control_type::make(std::move(mapping), size);
+            return u8string{u8view{
+                    u8view::buffer_type{data, size}, made.first.get()}};
+        }
+
+
+    }
+
+
+}
@@ -0,0 +1,379 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/cord/unicode-string.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+
+namespace f5 {
+
+
+    namespace cord {
+
+
+        /// ## Partitioning
+
+        /// Where the parts made by `partition` may start
+        enum class partition_boundary {
+            /// At the start of any code point
+            code_point,
+            /// After a `\n`
+            line
+        };
+
+
+        /**
+            Split a view into at most `n` parts of roughly the same size. The
+            parts are views of the same allocation that together cover the
+            whole view, and each starts on a boundary: for code points the
+            split is moved past any UTF-8 continuation bytes or trailing
+            UTF-16 surrogate, for lines it is moved past the next `\n`.
+            Parts that would be empty are left out, so there can be fewer
+            than `n` of them.
+         */
+        template<typename C, typename E, typename IM, typename R>
+        inline std::vector<basic_view<C, E, IM, R>> partition(
+                basic_view<C, E, IM, R> const v,
+                std::size_t n,
+                partition_boundary const boundary =
+                        partition_boundary::code_point) {
+            using view_type = basic_view<C, E, IM, R>;
+            auto const data = v.data();
+            auto const size = v.code_units();
+            n = std::max(n, std::size_t{1u});
+
+            /// Move a split forward to the next boundary
+            auto const snap = [&](std::size_t pos) {
+                if (boundary == partition_boundary::line) {
+                    auto const found =
+                            detail::find_unit(data + pos, size - pos, C{'\n'});
+                    return found == view_type::npos ? size : pos + found + 1u;
+                }
+                if constexpr (std::is_same_v<C, utf8>) {
+                    for (std::size_t skip{}; skip < 3u && pos < size
+                         && (static_cast<unsigned char>(data[pos]) & 0xc0)
+                                 == 0x80;
+                         ++skip) {
+                        ++pos;
+                    }
+                } else if constexpr (std::is_same_v<C, utf16>) {
+                    if (pos < size && (data[pos] & 0xfc00) == 0xdc00) ++pos;
+                }
+                return pos;
+            };
+
+            std::vector<view_type> parts;
+            parts.reserve(n);
+            std::size_t start{};
+            for (std::size_t p{1u}; p <= n && start < size; ++p) {
+                auto const end = p == n ? size
+                                        : std::max(start, snap(size / n * p));
+                if (end > start) {
+                    parts.push_back(view_type{
+                            typename view_type::buffer_type{
+                                    data + start, end - start},
+                            v.control_block()});
+                    start = end;
+                }
+            }
+            return parts;
+        }
+
+
+        /// ## Parallel kernels
+        /**
+            Versions of the bulk kernels that split long inputs with
+            `partition` and work on the parts on several threads. There are
+            more parts than threads, and each thread takes the next part
+            when it finishes one, so a slow part doesn't hold up the rest.
+            The results are the same as for the single threaded kernels.
+         */
+        namespace parallel {
+
+
+            struct options {
+                /// The number of threads to use, including the calling
+                /// one. Zero means one for each hardware thread.
+                std::size_t threads = 0u;
+                /// Inputs are never split into parts smaller than this many
+                /// bytes, so short inputs are done on the calling thread
+                std::size_t min_part = std::size_t{1u} << 20u;
+                /// The number of parts made for each thread
+                std::size_t parts_per_thread = 4u;
+            };
+
+
+        }
+
+
+        namespace detail {
+
+
+            inline std::size_t
+                    parallel_threads(parallel::options const &o) noexcept {
+                if (o.threads) return o.threads;
+                return std::max(std::thread::hardware_concurrency(), 1u);
+            }
+
+            /// Partition the view into the number of parts to use
+            template<typename V>
+            inline std::vector<V> parallel_parts(
+                    V const v,
+                    parallel::options const &o,
+                    partition_boundary const boundary =
+                            partition_boundary::code_point) {
+                std::size_t const one{1u};
+                auto const wanted =
+                        parallel_threads(o) * std::max(o.parts_per_thread, one);
+                auto const most = v.bytes() / std::max(o.min_part, one);
+                return partition(
+                        v, std::max(std::min(wanted, most), one), boundary);
+            }
+
+            /**
+                Call `f(n)` for each `n` less than `tasks`, spread over up to
+                `threads` threads including the calling one. The first
+                exception thrown is re-thrown once all of the threads are
+                done. If a thread can't be started the tasks are shared
+                between those that were.
+             */
+            template<typename F>
+            inline void parallel_for(
+                    std::size_t const tasks,
+                    std::size_t const threads,
+                    F const &f) {
+                std::atomic<std::size_t> next{0u};
+                std::mutex mutex;
+                std::exception_ptr error;
+                auto const work = [&]() {
+                    for (auto n = next++; n < tasks; n = next++) {
+                        try {
+                            f(n);
+                        } catch (...) {
+                            std::lock_guard<std::mutex> lock{mutex};
+                            if (not error) error = std::current_exception();
+                            next = tasks;
+                        }
+                    }
+                };
+                std::vector<std::thread> workers;
+                auto const helpers = std::min(threads, tasks);
+                try {
+                    workers.reserve(helpers);
+                    for (std::size_t t{1u}; t < helpers; ++t) {
+                        workers.emplace_back(work);
+                    }
+                } catch (...) {
+                    /// Out of threads or memory. `work` takes tasks until
+                    /// there are none left, so nothing is missed.
+                }
+                work();
+                for (auto &w : workers) w.join();
+                if (error) std::rethrow_exception(error);
+            }
+
+
+        }
+
+
+        namespace parallel {
+
+
+            /// The number of code units at the start of the view that are
+            /// validly encoded. See `f5::cord::valid_length`.
+            template<typename C, typename E, typename IM, typename R>
+            inline std::size_t valid_length(
+                    basic_view<C, E, IM, R> const v, options const o = {}) {
+                auto const parts = detail::parallel_parts(v, o);
+                std::vector<std::size_t> lengths(parts.size());
+                detail::parallel_for(
+                        parts.size(), detail::parallel_threads(o),
+                        [&](std::size_t const n) {
+                            lengths[n] = cord::valid_length(
+                                    static_cast<buffer<C const>>(parts[n]));
+                        });
+                /// Everything before the first part with an error is
+                /// valid, so that part starts on a real boundary and its
+                /// error is the first one
+                std::size_t length{};
+                for (std::size_t n{}; n < parts.size(); ++n) {
+                    length += lengths[n];
+                    if (lengths[n] < parts[n].code_units()) break;
+                }
+                return length;
+            }
+
+            /// The number of code points. See `f5::cord::count_code_points`.
+            template<typename C, typename E, typename IM, typename R>
+            inline std::size_t code_points(
+                    basic_view<C, E, IM, R> const v, options const o = {}) {
+                auto const parts = detail::parallel_parts(v, o);
+                std::vector<std::size_t> counts(parts.size());
+                detail::parallel_for(
+                        parts.size(), detail::parallel_threads(o),
+                        [&](std::size_t const n) {
+                            counts[n] = parts[n].code_points();
+                        });
+                std::size_t count{};
+                for (auto const c : counts) count += c;
+                return count;
+            }
+
+            /**
+                Transcode between UTF-8 and UTF-16. The parts are validated
+                and the length of their output worked out first, then the
+                result is allocated once and each part written to its place
+                in it. Invalid input, and the other encodings, are passed to
+                `f5::cord::transcode` to be handled in the usual way.
+             */
+            template<typename To, typename E = std::range_error, typename V>
+            inline basic_string<To> transcode(V const v, options const o = {}) {
+                using From = std::remove_const_t<typename V::value_type>;
+                basic_view<From> const in{
+                        static_cast<buffer<From const>>(v)};
+                if constexpr (
+                        (std::is_same_v<From, utf8>
+                         && std::is_same_v<To, utf16>)
+                        || (std::is_same_v<From, utf16>
+                            && std::is_same_v<To, utf8>)) {
+                    auto const parts = detail::parallel_parts(in, o);
+                    auto const threads = detail::parallel_threads(o);
+                    std::vector<std::size_t> offsets(parts.size() + 1u);
+                    std::atomic<bool> valid{true};
+                    detail::parallel_for(
+                            parts.size(), threads, [&](std::size_t const n) {
+                                auto const b = static_cast<buffer<From const>>(
+                                        parts[n]);
+                                if (cord::valid_length(b) != b.size()) {
+                                    valid = false;
+                                } else if constexpr (std::is_same_v<
+                                                             From, utf8>) {
+                                    offsets[n + 1u] = detail::u8u16length(
+                                            b.data(), b.size());
+                                } else {
+                                    offsets[n + 1u] = detail::u16u8length(
+                                            b.data(), b.size());
+                                }
+                            });
+                    if (not valid) { return cord::transcode<To, E>(in); }
+                    std::partial_sum(
+                            offsets.begin(), offsets.end(), offsets.begin());
+                    return basic_string<To>::build([&](auto allocate) {
+                        auto const out = allocate(offsets.back());
+                        detail::parallel_for(
+                                parts.size(), threads,
+                                [&](std::size_t const n) {
+                                    auto const b = static_cast<
+                                            buffer<From const>>(parts[n]);
+                                    if constexpr (std::is_same_v<From, utf8>) {
+                                        detail::u8u16(
+                                                reinterpret_cast<
+                                                        unsigned char const *>(
+                                                        b.data()),
+                                                b.size(), out + offsets[n],
+                                                offsets[n + 1u] - offsets[n]);
+                                    } else {
+                                        detail::u16u8(
+                                                b.data(), b.size(),
+                                                out + offsets[n]);
+                                    }
+                                });
+                        return offsets.back();
+                    });
+                } else {
+                    return cord::transcode<To, E>(in);
+                }
+            }
+
+            /**
+                The offsets of the places `needle` appears, without the
+                matches overlapping, the same as those counted by `count`.
+                Each part is searched from its start, stepping over each
+                match as `count` does, and including matches that run on
+                into the next part. Where the first of a part's matches
+                overlaps the last one kept from the part before, the merge
+                searches again from the end of that match until it comes
+                back into step with the part's own matches. For most
+                needles that is straight away, but for needles that overlap
+                themselves, like a run of one character, it can take the
+                rest of the part.
+             */
+            template<typename C, typename E, typename IM, typename R>
+            inline std::vector<std::size_t> find_all(
+                    basic_view<C, E, IM, R> const v,
+                    basic_view<C, E, IM, R> const needle,
+                    options const o = {}) {
+                std::vector<std::size_t> found;
+                auto const m = needle.code_units();
+                if (m == 0u || m > v.code_units()) return found;
+                auto const parts = detail::parallel_parts(v, o);
+                /// The first match starting at or after `from` and before
+                /// `before`, or `npos`
+                auto const search = [&](std::size_t const from,
+                                        std::size_t const before) {
+                    auto const end = std::min(before + m - 1u, v.code_units());
+                    if (from >= before) return detail::search_npos;
+                    auto const f = detail::find_units(
+                            v.data() + from, end - from, needle.data(), m);
+                    return f == detail::search_npos || from + f >= before
+                            ? detail::search_npos
+                            : from + f;
+                };
+                std::vector<std::vector<std::size_t>> matches(parts.size());
+                detail::parallel_for(
+                        parts.size(), detail::parallel_threads(o),
+                        [&](std::size_t const n) {
+                            std::size_t const offset =
+                                    parts[n].data() - v.data();
+                            auto const end = offset + parts[n].code_units();
+                            for (auto at = search(offset, end);
+                                 at != detail::search_npos;
+                                 at = search(at + m, end)) {
+                                matches[n].push_back(at);
+                            }
+                        });
+                for (std::size_t n{}; n < parts.size(); ++n) {
+                    auto const &part = matches[n];
+                    std::size_t const end = parts[n].data() - v.data()
+                            + parts[n].code_units();
+                    std::size_t i{};
+                    while (true) {
+                        auto const resume =
+                                found.empty() ? 0u : found.back() + m;
+                        while (i < part.size() && part[i] < resume) ++i;
+                        /// Once a dropped match has been stepped over the
+                        /// part's matches are those `count` would find
+                        if (i == 0u || resume >= part[i - 1u] + m) break;
+                        auto const at = search(
+                                resume, i < part.size() ? part[i] : end);
+                        if (at == detail::search_npos) break;
+                        found.push_back(at);
+                    }
+                    found.insert(found.end(), part.begin() + i, part.end());
+                }
+                return found;
+            }
+
+
+        }
+
+
+    }
+
+
+}
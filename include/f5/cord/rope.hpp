@@ -0,0 +1,473 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/cord/unicode-string.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+
+namespace f5 {
+
+
+    namespace cord {
+
+
+        /// ## `rope`
+        /**
+            An immutable UTF-8 string made up of a balanced tree of
+            `u8string` leaves. Concatenation and substrings take
+            logarithmic time and share the leaves (and their control
+            blocks) with the ropes they came from, so building a large
+            string from many fragments doesn't copy them over and over.
+
+            The tree is kept balanced in the same way as an AVL tree. Very
+            short leaves next to each other are merged when ropes are joined
+            so that appending many small fragments doesn't make a leaf for
+            each one.
+         */
+        class rope {
+            struct node;
+
+            /// Shared ownership of a node
+            struct link {
+                control<> *owner = nullptr;
+                node const *item = nullptr;
+
+                link() noexcept {}
+                link(link const &l) noexcept
+                : owner{control<>::increment(l.owner)}, item{l.item} {}
+                link(link &&l) noexcept
+                : owner{std::exchange(l.owner, nullptr)},
+                  item{std::exchange(l.item, nullptr)} {}
+                link &operator=(link l) noexcept {
+                    std::swap(owner, l.owner);
+                    std::swap(item, l.item);
+                    return *this;
+                }
+                ~link() { control<>::decrement(owner); }
+
+                explicit operator bool() const noexcept {
+                    return item != nullptr;
+                }
+                node const *operator->() const noexcept { return item; }
+            };
+
+            /// A leaf has a non-empty `leaf` string. A branch has two
+            /// non-empty children and an empty `leaf`.
+            struct node {
+                u8string leaf;
+                link left, right;
+                std::size_t bytes, code_points, height;
+
+                bool is_leaf() const noexcept { return not left; }
+            };
+
+            link root;
+
+            explicit rope(link r) noexcept : root{std::move(r)} {}
+
+
+            static link make(node n) {
+                auto made = control<>::make(std::move(n));
+                link l;
+                l.item = made.second;
+                l.owner = made.first.release();
+                return l;
+            }
+            static link leaf(u8string s) {
+                if (s.empty()) return {};
+                auto const bytes = s.code_units(),
+                           code_points = s.code_points();
+                return make(node{std::move(s), {}, {}, bytes, code_points, 0u});
+            }
+            static link branch(link l, link r) {
+                auto const bytes = l->bytes + r->bytes,
+                           code_points = l->code_points + r->code_points,
+                           height = 1u + std::max(l->height, r->height);
+                return make(node{
+                        {}, std::move(l), std::move(r), bytes, code_points,
+                        height});
+            }
+            static std::size_t height(link const &n) noexcept {
+                return n ? n->height : 0u;
+            }
+
+            /// Make a branch from two sub-trees whose heights differ by
+            /// at most two, rotating if needed to restore the balance
+            static link balance(link l, link r) {
+                auto const hl = height(l), hr = height(r);
+                if (hl > hr + 1u) {
+                    if (height(l->left) >= height(l->right)) {
+                        return branch(l->left, branch(l->right, std::move(r)));
+                    } else {
+                        auto const &m = l->right;
+                        return branch(
+                                branch(l->left, m->left),
+                                branch(m->right, std::move(r)));
+                    }
+                } else if (hr > hl + 1u) {
+                    if (height(r->right) >= height(r->left)) {
+                        return branch(branch(std::move(l), r->left), r->right);
+                    } else {
+                        auto const &m = r->left;
+                        return branch(
+                                branch(std::move(l), m->left),
+                                branch(m->right, r->right));
+                    }
+                } else {
+                    return branch(std::move(l), std::move(r));
+                }
+            }
+
+            /// Join two trees. This only makes new nodes along the edge of
+            /// the taller tree down to the height of the shorter one.
+            static link join(link l, link r) {
+                if (not l) return r;
+                if (not r) return l;
+                if (l->is_leaf() && r->is_leaf()
+                    && l->bytes + r->bytes <= merge_limit) {
+                    return leaf(l->leaf + r->leaf);
+                }
+                auto const hl = l->height, hr = r->height;
+                if (hl > hr + 1u) {
+                    return balance(l->left, join(l->right, std::move(r)));
+                } else if (hr > hl + 1u) {
+                    return balance(join(std::move(l), r->left), r->right);
+                } else {
+                    return branch(std::move(l), std::move(r));
+                }
+            }
+
+            /// The bytes `[s, e)` of a tree
+            static link slice(link const &n, std::size_t s, std::size_t e) {
+                if (s >= e) {
+                    return {};
+                } else if (s == 0u && e == n->bytes) {
+                    return n;
+                } else if (n->is_leaf()) {
+                    u8view const v{n->leaf};
+                    return leaf(u8string{u8view{
+                            static_cast<u8view::buffer_type>(v).slice(s, e - s),
+                            v.control_block()}});
+                } else {
+                    auto const middle = n->left->bytes;
+                    if (e <= middle) {
+                        return slice(n->left, s, e);
+                    } else if (s >= middle) {
+                        return slice(n->right, s - middle, e - middle);
+                    } else {
+                        return join(
+                                slice(n->left, s, middle),
+                                slice(n->right, 0u, e - middle));
+                    }
+                }
+            }
+
+            /// The byte offset of code point `cp`, which must not be past
+            /// the end of the tree
+            static std::size_t offset(node const *n, std::size_t cp) {
+                std::size_t bytes{};
+                while (not n->is_leaf()) {
+                    auto const &l = n->left;
+                    if (cp < l->code_points) {
+                        n = l.item;
+                    } else {
+                        cp -= l->code_points;
+                        bytes += l->bytes;
+                        n = n->right.item;
+                    }
+                }
+                u8view const v{n->leaf};
+                return bytes + (v.substr(cp).data() - v.data());
+            }
+            std::size_t offset(std::size_t const cp) const {
+                if (cp >= code_points()) {
+                    return bytes();
+                } else {
+                    return offset(root.item, cp);
+                }
+            }
+
+          public:
+            /// Neighbouring leaves are merged when joining if they have no
+            /// more than this many bytes between them
+            static constexpr std::size_t merge_limit = 64u;
+
+
+            /// ## Constructors
+            rope() noexcept {}
+            rope(u8string s) : root{leaf(std::move(s))} {}
+            rope(u8view v) : rope{u8string{v}} {}
+            template<std::size_t N>
+            rope(char const (&s)[N]) : rope{u8string{s}} {}
+
+
+            /// ## Queries
+
+            /// Return the size in bytes
+            std::size_t bytes() const noexcept {
+                return root ? root->bytes : 0u;
+            }
+            /// Return the number of code units, which is the same as the
+            /// number of bytes
+            std::size_t code_units() const noexcept { return bytes(); }
+            /// Return the number of code points. This is stored in the tree
+            /// so takes constant time.
+            std::size_t code_points() const noexcept {
+                return root ? root->code_points : 0u;
+            }
+            /// Return true if the rope is empty
+            bool empty() const noexcept { return not root; }
+            /// The height of the tree, which is zero for an empty rope or
+            /// a single leaf
+            std::size_t height() const noexcept { return height(root); }
+
+
+            /// ## Concatenation
+            friend rope operator+(rope const &l, rope const &r) {
+                return rope{join(l.root, r.root)};
+            }
+            rope &operator+=(rope const &r) {
+                root = join(std::move(root), r.root);
+                return *this;
+            }
+
+
+            /// ## Substrings
+
+            /// Substrings by byte offsets. The offsets must fall on code
+            /// point boundaries, and `e` is clamped to the end of the rope.
+            rope substr_bytes(std::size_t s, std::size_t e = npos) const {
+                e = std::min(e, bytes());
+                if (not root || s >= e) return {};
+                return rope{slice(root, s, e)};
+            }
+            /// Substrings by code point offsets, like `basic_string`. The
+            /// result is empty if the end marker is smaller than the start.
+            rope substr(std::size_t const s) const {
+                return substr_bytes(offset(s));
+            }
+            rope substr_pos(std::size_t const s, std::size_t const e) const {
+                return substr_bytes(offset(s), offset(e));
+            }
+            static constexpr std::size_t npos = u8view::npos;
+
+
+            /// ## Iteration
+
+            /// Iterates over the leaves of the rope giving a view of each
+            /// in turn. The views share the leaves' control blocks.
+            class chunk_iterator {
+                friend class rope;
+                /// The top of the stack is the current leaf and below it
+                /// are the sub-trees still to be visited
+                std::vector<node const *> stack;
+
+                void descend(node const *n) {
+                    while (not n->is_leaf()) {
+                        stack.push_back(n->right.item);
+                        n = n->left.item;
+                    }
+                    stack.push_back(n);
+                }
+
+              public:
+                using difference_type = std::ptrdiff_t;
+                using value_type = u8view;
+                using pointer = void;
+                using reference = u8view;
+                using iterator_category = std::forward_iterator_tag;
+
+                chunk_iterator() noexcept {}
+                explicit chunk_iterator(rope const &r) {
+                    if (r.root) descend(r.root.item);
+                }
+
+                u8view operator*() const { return stack.back()->leaf; }
+                chunk_iterator &operator++() {
+                    stack.pop_back();
+                    if (not stack.empty()) {
+                        auto const next = stack.back();
+                        stack.pop_back();
+                        descend(next);
+                    }
+                    return *this;
+                }
+                chunk_iterator operator++(int) {
+                    auto ret = *this;
+                    ++(*this);
+                    return ret;
+                }
+
+                bool operator==(chunk_iterator const &i) const noexcept {
+                    return stack.size() == i.stack.size()
+                            && (stack.empty() || stack.back() == i.stack.back());
+                }
+                bool operator!=(chunk_iterator const &i) const noexcept {
+                    return not(*this == i);
+                }
+            };
+
+            /// The range of leaves
+            struct chunk_range {
+                chunk_iterator first;
+                chunk_iterator begin() const { return first; }
+                chunk_iterator end() const { return {}; }
+            };
+            chunk_range chunks() const { return {chunk_iterator{*this}}; }
+
+
+            /// An iterator that produces the UTF-32 code points of the rope
+            class const_iterator {
+                chunk_iterator chunk;
+                u8view::const_iterator pos, end;
+
+                void start() {
+                    if (chunk != chunk_iterator{}) {
+                        u8view const v = *chunk;
+                        pos = v.begin();
+                        end = v.end();
+                    }
+                }
+
+              public:
+                using difference_type = std::ptrdiff_t;
+                using value_type = utf32;
+                using pointer = utf32 const *;
+                using reference = utf32;
+                using iterator_category = std::forward_iterator_tag;
+
+                const_iterator() noexcept {}
+                explicit const_iterator(chunk_iterator c)
+                : chunk{std::move(c)} {
+                    start();
+                }
+
+                utf32 operator*() const { return *pos; }
+                const_iterator &operator++() {
+                    if (++pos == end) {
+                        ++chunk;
+                        start();
+                    }
+                    return *this;
+                }
+                const_iterator operator++(int) {
+                    auto ret = *this;
+                    ++(*this);
+                    return ret;
+                }
+
+                bool operator==(const_iterator const &i) const noexcept {
+                    return chunk == i.chunk
+                            && (chunk == chunk_iterator{}
+                                || pos.iterator == i.pos.iterator);
+                }
+                bool operator!=(const_iterator const &i) const noexcept {
+                    return not(*this == i);
+                }
+            };
+            const_iterator begin() const {
+                return const_iterator{chunk_iterator{*this}};
+            }
+            const_iterator end() const { return {}; }
+
+
+            /// ## Conversions
+
+            /// Return the rope as a single string. A rope that is a single
+            /// leaf returns that leaf, otherwise the bytes are copied into
+            /// one new allocation.
+            u8string flatten() const {
+                if (not root) {
+                    return {};
+                } else if (root->is_leaf()) {
+                    return root->leaf;
+                } else {
+                    return u8string::build([this](auto allocate) {
+                        auto out = allocate(bytes());
+                        for (auto const chunk : chunks()) {
+                            std::char_traits<char>::copy(
+                                    out, chunk.data(), chunk.code_units());
+                            out += chunk.code_units();
+                        }
+                        return bytes();
+                    });
+                }
+            }
+
+
+            /// ## Comparisons
+
+            /// Compares the bytes, without building a flattened copy
+            template<
+                    typename V,
+                    typename = std::enable_if_t<
+                            std::is_convertible_v<V const &, u8view>>>
+            friend bool operator==(rope const &l, V const &v) {
+                u8view const r{v};
+                if (l.bytes() != r.code_units()) return false;
+                std::size_t pos{};
+                for (auto const chunk : l.chunks()) {
+                    if (std::memcmp(
+                                chunk.data(), r.data() + pos,
+                                chunk.code_units())
+                        != 0) {
+                        return false;
+                    }
+                    pos += chunk.code_units();
+                }
+                return true;
+            }
+            friend bool operator==(rope const &l, rope const &r) {
+                if (l.bytes() != r.bytes()) return false;
+                auto lc = l.chunks().begin(), rc = r.chunks().begin();
+                std::size_t lpos{}, rpos{};
+                for (std::size_t done{}; done < l.bytes();) {
+                    u8view const lv = *lc, rv = *rc;
+                    auto const n = std::min(
+                            lv.code_units() - lpos, rv.code_units() - rpos);
+                    if (std::memcmp(lv.data() + lpos, rv.data() + rpos, n)
+                        != 0) {
+                        return false;
+                    }
+                    done += n;
+                    lpos += n;
+                    rpos += n;
+                    if (lpos == lv.code_units()) {
+                        ++lc;
+                        lpos = 0u;
+                    }
+                    if (rpos == rv.code_units()) {
+                        ++rc;
+                        rpos = 0u;
+                    }
+                }
+                return true;
+            }
+            template<
+                    typename V,
+                    typename = std::enable_if_t<
+                            std::is_convertible_v<V const &, u8view>>>
+            friend bool operator!=(rope const &l, V const &r) {
+                return not(l == r);
+            }
+            friend bool operator!=(rope const &l, rope const &r) {
+                return not(l == r);
+            }
+        };
+
+
+    }
+
+
+}
@@ -0,0 +1,475 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+
+/**
+    The bulk kernels are selected at compile time from the instruction sets
+    the compiler has been told it may use (e.g. through `-msse4.2`,
+    `-mavx2` or `-march=native`). Each wider instruction set implies the
+    narrower ones so exactly one of the wrappers below is chosen as the
+    `native` one. Defining `F5_CORD_NO_SIMD` forces the scalar code.
+ */
+#if not defined(F5_CORD_NO_SIMD) && (defined(__x86_64__) || defined(__i386__))
+#if defined(__SSE4_2__)
+#define F5_CORD_SIMD_SSE42 1
+#endif
+#if defined(__AVX2__)
+#define F5_CORD_SIMD_AVX2 1
+#endif
+#if defined(__AVX512BW__)
+#define F5_CORD_SIMD_AVX512 1
+#endif
+#endif
+
+#if defined(F5_CORD_SIMD_SSE42)
+#include <immintrin.h>
+#endif
+
+
+namespace f5 {
+
+
+    namespace cord {
+
+
+        namespace simd {
+
+
+            /// Load an unaligned machine word from memory
+            inline std::uint64_t load64(void const *p) noexcept {
+                std::uint64_t w;
+                std::memcpy(&w, p, sizeof(w));
+                return w;
+            }
+            /// True if no byte in the word has its high bit set
+            constexpr inline bool is_ascii(std::uint64_t w) noexcept {
+                return (w & 0x8080'8080'8080'8080u) == 0u;
+            }
+            /// Count the set bits
+            constexpr inline std::size_t popcount(std::uint64_t m) noexcept {
+                return __builtin_popcountll(m);
+            }
+            /// Index of the lowest set bit. `m` must not be zero.
+            constexpr inline std::size_t lowest(std::uint64_t m) noexcept {
+                return __builtin_ctzll(m);
+            }
+            /// Index of the highest set bit. `m` must not be zero.
+            constexpr inline std::size_t highest(std::uint64_t m) noexcept {
+                return 63u - __builtin_clzll(m);
+            }
+
+
+#if defined(F5_CORD_SIMD_SSE42)
+            /// 16 byte vectors
+            struct sse42 {
+                using vector = __m128i;
+                using mask = std::uint64_t;
+                static constexpr std::size_t width = 16;
+
+                static vector load(void const *p) noexcept {
+                    return _mm_loadu_si128(static_cast<__m128i const *>(p));
+                }
+                static void store(void *p, vector v) noexcept {
+                    _mm_storeu_si128(static_cast<__m128i *>(p), v);
+                }
+                static vector zero() noexcept { return _mm_setzero_si128(); }
+                static vector splat(std::uint8_t b) noexcept {
+                    return _mm_set1_epi8(static_cast<char>(b));
+                }
+                /// A lookup table for `lookup`
+                static vector table(std::uint8_t const (&t)[16]) noexcept {
+                    return load(t);
+                }
+                /// Use the bottom four bits of each `index` byte to pick
+                /// the byte from the table
+                static vector lookup(vector t, vector index) noexcept {
+                    return _mm_shuffle_epi8(t, index);
+                }
+                static vector high_nibbles(vector v) noexcept {
+                    return _mm_and_si128(_mm_srli_epi16(v, 4), splat(0x0f));
+                }
+                static vector low_nibbles(vector v) noexcept {
+                    return _mm_and_si128(v, splat(0x0f));
+                }
+                static vector bit_and(vector l, vector r) noexcept {
+                    return _mm_and_si128(l, r);
+                }
+                static vector bit_or(vector l, vector r) noexcept {
+                    return _mm_or_si128(l, r);
+                }
+                static vector bit_xor(vector l, vector r) noexcept {
+                    return _mm_xor_si128(l, r);
+                }
+                static vector saturating_sub(vector l, vector r) noexcept {
+                    return _mm_subs_epu8(l, r);
+                }
+                /// The input shifted along by `N` bytes with the gap filled
+                /// by the last bytes from the previous input
+                template<int N>
+                static vector prev(vector input, vector previous) noexcept {
+                    return _mm_alignr_epi8(input, previous, 16 - N);
+                }
+                static bool any(vector v) noexcept {
+                    return not _mm_testz_si128(v, v);
+                }
+                /// Bit mask of the bytes with their high bit set
+                static mask high_bits(vector v) noexcept {
+                    return static_cast<std::uint16_t>(_mm_movemask_epi8(v));
+                }
+                static bool is_ascii(vector v) noexcept {
+                    return high_bits(v) == 0u;
+                }
+                /// Bit mask of equal bytes
+                static mask equal(vector l, vector r) noexcept {
+                    return high_bits(_mm_cmpeq_epi8(l, r));
+                }
+                /// Bit mask of bytes where the signed comparison `l > r` holds
+                static mask greater(vector l, vector r) noexcept {
+                    return high_bits(_mm_cmpgt_epi8(l, r));
+                }
+                /// Operations on 16 bit lanes. The masks have two bits per
+                /// lane
+                static vector splat16(std::uint16_t w) noexcept {
+                    return _mm_set1_epi16(static_cast<short>(w));
+                }
+                static mask equal16(vector l, vector r) noexcept {
+                    return high_bits(_mm_cmpeq_epi16(l, r));
+                }
+                /// Equal 32 bit lanes, with four bits per lane in the mask
+                static mask equal32(vector l, vector r) noexcept {
+                    return high_bits(_mm_cmpeq_epi32(l, r));
+                }
+                /// Store the bytes zero extended to 16 bits, `2 * width`
+                /// bytes are written
+                static void store16(void *p, vector v) noexcept {
+                    auto const out = static_cast<__m128i *>(p);
+                    _mm_storeu_si128(out, _mm_unpacklo_epi8(v, zero()));
+                    _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(v, zero()));
+                }
+                /// Pack two vectors of 16 bit lanes into one of bytes, in
+                /// order. Values above 0xff saturate.
+                static vector pack16(vector l, vector h) noexcept {
+                    return _mm_packus_epi16(l, h);
+                }
+                static vector splat32(std::uint32_t w) noexcept {
+                    return _mm_set1_epi32(static_cast<int>(w));
+                }
+                /// Store the bytes zero extended to 32 bits, `4 * width`
+                /// bytes are written
+                static void store32(void *p, vector v) noexcept {
+                    auto const out = static_cast<__m128i *>(p);
+                    _mm_storeu_si128(out, _mm_cvtepu8_epi32(v));
+                    _mm_storeu_si128(
+                            out + 1, _mm_cvtepu8_epi32(_mm_srli_si128(v, 4)));
+                    _mm_storeu_si128(
+                            out + 2, _mm_cvtepu8_epi32(_mm_srli_si128(v, 8)));
+                    _mm_storeu_si128(
+                            out + 3, _mm_cvtepu8_epi32(_mm_srli_si128(v, 12)));
+                }
+                /// Pack two vectors of 32 bit lanes into one of 16 bit
+                /// lanes, in order. Values above 0xffff saturate.
+                static vector pack32(vector l, vector h) noexcept {
+                    return _mm_packus_epi32(l, h);
+                }
+            };
+#endif
+
+
+#if defined(F5_CORD_SIMD_AVX2)
+            /// 32 byte vectors
+            struct avx2 {
+                using vector = __m256i;
+                using mask = std::uint64_t;
+                static constexpr std::size_t width = 32;
+
+                static vector load(void const *p) noexcept {
+                    return _mm256_loadu_si256(static_cast<__m256i const *>(p));
+                }
+                static void store(void *p, vector v) noexcept {
+                    _mm256_storeu_si256(static_cast<__m256i *>(p), v);
+                }
+                static vector zero() noexcept { return _mm256_setzero_si256(); }
+                static vector splat(std::uint8_t b) noexcept {
+                    return _mm256_set1_epi8(static_cast<char>(b));
+                }
+                static vector table(std::uint8_t const (&t)[16]) noexcept {
+                    return _mm256_broadcastsi128_si256(sse42::table(t));
+                }
+                static vector lookup(vector t, vector index) noexcept {
+                    return _mm256_shuffle_epi8(t, index);
+                }
+                static vector high_nibbles(vector v) noexcept {
+                    return _mm256_and_si256(
+                            _mm256_srli_epi16(v, 4), splat(0x0f));
+                }
+                static vector low_nibbles(vector v) noexcept {
+                    return _mm256_and_si256(v, splat(0x0f));
+                }
+                static vector bit_and(vector l, vector r) noexcept {
+                    return _mm256_and_si256(l, r);
+                }
+                static vector bit_or(vector l, vector r) noexcept {
+                    return _mm256_or_si256(l, r);
+                }
+                static vector bit_xor(vector l, vector r) noexcept {
+                    return _mm256_xor_si256(l, r);
+                }
+                static vector saturating_sub(vector l, vector r) noexcept {
+                    return _mm256_subs_epu8(l, r);
+                }
+                template<int N>
+                static vector prev(vector input, vector previous) noexcept {
+                    return _mm256_alignr_epi8(
+                            input,
+                            _mm256_permute2x128_si256(previous, input, 0x21),
+                            16 - N);
+                }
+                static bool any(vector v) noexcept {
+                    return not _mm256_testz_si256(v, v);
+                }
+                static mask high_bits(vector v) noexcept {
+                    return static_cast<std::uint32_t>(_mm256_movemask_epi8(v));
+                }
+                static bool is_ascii(vector v) noexcept {
+                    return high_bits(v) == 0u;
+                }
+                static mask equal(vector l, vector r) noexcept {
+                    return high_bits(_mm256_cmpeq_epi8(l, r));
+                }
+                static mask greater(vector l, vector r) noexcept {
+                    return high_bits(_mm256_cmpgt_epi8(l, r));
+                }
+                static vector splat16(std::uint16_t w) noexcept {
+                    return _mm256_set1_epi16(static_cast<short>(w));
+                }
+                static mask equal16(vector l, vector r) noexcept {
+                    return high_bits(_mm256_cmpeq_epi16(l, r));
+                }
+                static mask equal32(vector l, vector r) noexcept {
+                    return high_bits(_mm256_cmpeq_epi32(l, r));
+                }
+                static void store16(void *p, vector v) noexcept {
+                    auto const out = static_cast<__m256i *>(p);
+                    _mm256_storeu_si256(
+                            out,
+                            _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+                    _mm256_storeu_si256(
+                            out + 1,
+                            _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+                }
+                static vector pack16(vector l, vector h) noexcept {
+                    return _mm256_permute4x64_epi64(
+                            _mm256_packus_epi16(l, h), 0xd8);
+                }
+                static vector splat32(std::uint32_t w) noexcept {
+                    return _mm256_set1_epi32(static_cast<int>(w));
+                }
+                static void store32(void *p, vector v) noexcept {
+                    auto const out = static_cast<__m256i *>(p);
+                    auto const l = _mm256_castsi256_si128(v),
+                               h = _mm256_extracti128_si256(v, 1);
+                    _mm256_storeu_si256(out, _mm256_cvtepu8_epi32(l));
+                    _mm256_storeu_si256(
+                            out + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(l, 8)));
+                    _mm256_storeu_si256(out + 2, _mm256_cvtepu8_epi32(h));
+                    _mm256_storeu_si256(
+                            out + 3, _mm256_cvtepu8_epi32(_mm_srli_si128(h, 8)));
+                }
+                static vector pack32(vector l, vector h) noexcept {
+                    return _mm256_permute4x64_epi64(
+                            _mm256_packus_epi32(l, h), 0xd8);
+                }
+            };
+#endif
+
+
+#if defined(F5_CORD_SIMD_AVX512)
+            /// 64 byte vectors
+            struct avx512 {
+                using vector = __m512i;
+                using mask = std::uint64_t;
+                static constexpr std::size_t width = 64;
+
+                static vector load(void const *p) noexcept {
+                    return _mm512_loadu_si512(p);
+                }
+                static void store(void *p, vector v) noexcept {
+                    _mm512_storeu_si512(p, v);
+                }
+                static vector zero() noexcept { return _mm512_setzero_si512(); }
+                static vector splat(std::uint8_t b) noexcept {
+                    return _mm512_set1_epi8(static_cast<char>(b));
+                }
+                static vector table(std::uint8_t const (&t)[16]) noexcept {
+                    return _mm512_broadcast_i32x4(sse42::table(t));
+                }
+                static vector lookup(vector t, vector index) noexcept {
+                    return _mm512_shuffle_epi8(t, index);
+                }
+                static vector high_nibbles(vector v) noexcept {
+                    return _mm512_and_si512(
+                            _mm512_srli_epi16(v, 4), splat(0x0f));
+                }
+                static vector low_nibbles(vector v) noexcept {
+                    return _mm512_and_si512(v, splat(0x0f));
+                }
+                static vector bit_and(vector l, vector r) noexcept {
+                    return _mm512_and_si512(l, r);
+                }
+                static vector bit_or(vector l, vector r) noexcept {
+                    return _mm512_or_si512(l, r);
+                }
+                static vector bit_xor(vector l, vector r) noexcept {
+                    return _mm512_xor_si512(l, r);
+                }
+                static vector saturating_sub(vector l, vector r) noexcept {
+                    return _mm512_subs_epu8(l, r);
+                }
+                /// Each 128 bit lane is joined with the lane before it, which
+                /// for the first lane is the last lane of `previous`
+                template<int N>
+                static vector prev(vector input, vector previous) noexcept {
+                    auto const lanes = _mm512_permutex2var_epi64(
+                            input, _mm512_set_epi64(5, 4, 3, 2, 1, 0, 15, 14),
+                            previous);
+                    return _mm512_alignr_epi8(input, lanes, 16 - N);
+                }
+                static bool any(vector v) noexcept {
+                    return _mm512_test_epi8_mask(v, v) != 0u;
+                }
+                static mask high_bits(vector v) noexcept {
+                    return _mm512_movepi8_mask(v);
+                }
+                static bool is_ascii(vector v) noexcept {
+                    return high_bits(v) == 0u;
+                }
+                static mask equal(vector l, vector r) noexcept {
+                    return _mm512_cmpeq_epi8_mask(l, r);
+                }
+                static mask greater(vector l, vector r) noexcept {
+                    return _mm512_cmpgt_epi8_mask(l, r);
+                }
+                static vector splat16(std::uint16_t w) noexcept {
+                    return _mm512_set1_epi16(static_cast<short>(w));
+                }
+                static mask equal16(vector l, vector r) noexcept {
+                    return high_bits(
+                            _mm512_movm_epi16(_mm512_cmpeq_epi16_mask(l, r)));
+                }
+                static mask equal32(vector l, vector r) noexcept {
+                    return high_bits(_mm512_maskz_mov_epi32(
+                            _mm512_cmpeq_epi32_mask(l, r),
+                            _mm512_set1_epi32(-1)));
+                }
+                static void store16(void *p, vector v) noexcept {
+                    auto const out = static_cast<__m512i *>(p);
+                    _mm512_storeu_si512(
+                            out,
+                            _mm512_cvtepu8_epi16(_mm512_castsi512_si256(v)));
+                    _mm512_storeu_si512(
+                            out + 1,
+                            _mm512_cvtepu8_epi16(
+                                    _mm512_extracti64x4_epi64(v, 1)));
+                }
+                static vector pack16(vector l, vector h) noexcept {
+                    return _mm512_permutexvar_epi64(
+                            _mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0),
+                            _mm512_packus_epi16(l, h));
+                }
+                static vector splat32(std::uint32_t w) noexcept {
+                    return _mm512_set1_epi32(static_cast<int>(w));
+                }
+                static void store32(void *p, vector v) noexcept {
+                    auto const out = static_cast<__m512i *>(p);
+                    _mm512_storeu_si512(
+                            out,
+                            _mm512_cvtepu8_epi32(_mm512_castsi512_si128(v)));
+                    _mm512_storeu_si512(
+                            out + 1,
+                            _mm512_cvtepu8_epi32(
+                                    _mm512_extracti32x4_epi32(v, 1)));
+                    _mm512_storeu_si512(
+                            out + 2,
+                            _mm512_cvtepu8_epi32(
+                                    _mm512_extracti32x4_epi32(v, 2)));
+                    _mm512_storeu_si512(
+                            out + 3,
+                            _mm512_cvtepu8_epi32(
+                                    _mm512_extracti32x4_epi32(v, 3)));
+                }
+                static vector pack32(vector l, vector h) noexcept {
+                    return _mm512_permutexvar_epi64(
+                            _mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0),
+                            _mm512_packus_epi32(l, h));
+                }
+            };
+#endif
+
+
+            /// The widest vector type the compiler may use, if any
+#if defined(F5_CORD_SIMD_AVX512)
+            using native = avx512;
+#elif defined(F5_CORD_SIMD_AVX2)
+            using native = avx2;
+#elif defined(F5_CORD_SIMD_SSE42)
+            using native = sse42;
+#endif
+
+
+            /// Returns the length of the run of ASCII at the start of the
+            /// data, checking a vector at a time
+            inline std::size_t
+                    ascii_length(char const *const s, std::size_t const size) noexcept {
+                std::size_t pos{};
+#if defined(F5_CORD_SIMD_SSE42)
+                for (; size - pos >= native::width; pos += native::width) {
+                    auto const high = native::high_bits(native::load(s + pos));
+                    if (high) { return pos + lowest(high); }
+                }
+#endif
+                for (; size - pos >= 8u; pos += 8u) {
+                    if (not is_ascii(load64(s + pos))) break;
+                }
+                for (; pos < size; ++pos) {
+                    if (static_cast<unsigned char>(s[pos]) >= 0x80) break;
+                }
+                return pos;
+            }
+
+
+            /// Returns true if the CPU we are running on supports the
+            /// instructions the kernels were compiled for. Useful as a
+            /// start up check for binaries built with `-march` settings
+            /// aimed at other machines.
+            inline bool cpu_supported() noexcept {
+#if defined(F5_CORD_SIMD_AVX512)
+                return __builtin_cpu_supports("avx512bw");
+#elif defined(F5_CORD_SIMD_AVX2)
+                return __builtin_cpu_supports("avx2");
+#elif defined(F5_CORD_SIMD_SSE42)
+                return __builtin_cpu_supports("sse4.2");
+#else
+                return true;
+#endif
+            }
+
+
+        }
+
+
+    }
+
+
+}
@@ -0,0 +1,197 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/cord/unicode-string.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+
+
+namespace f5 {
+
+
+    namespace cord {
+
+
+        /// ## `u8string_builder`
+        /**
+            Builds a `u8string` a piece at a time. The code units are
+            written into a control block laid out exactly as a `u8string`'s,
+            so `finish` hands the allocation over to the string without
+            copying it.
+
+            `snapshot` returns the content so far as a string that shares the
+            builder's allocation. Appending after a snapshot only writes past
+            the end of it, so the snapshot never changes. When the builder
+            runs out of space it moves to a new allocation twice the size,
+            leaving any snapshots to keep the old one alive.
+
+            A builder must only be used by one thread at a time. Its
+            snapshots can be passed to other threads. Once a snapshot has
+            been taken the control block is never written to again, so
+            those threads can read it safely. This means that if any
+            snapshots are still alive when the builder is finished the
+            string it returns can't be marked as NUL terminated, and its
+            `shrink_to_fit` will make a copy.
+         */
+        class u8string_builder {
+            using control_type = u8view::control_type;
+
+            /// While the builder is using it the control block's
+            /// `user_data` is `unfinished`, so strings sharing it know
+            /// they are not NUL terminated. `finish` sets it to the size
+            /// if nothing else is sharing the block.
+            static constexpr std::size_t unfinished =
+                    std::numeric_limits<std::size_t>::max();
+
+            control_type *owner = nullptr;
+            char *start = nullptr;
+            std::size_t used = {}, space = {};
+
+            /// Move to an allocation with room for at least `capacity`
+            /// code units
+            void reallocate(std::size_t const capacity) {
+                auto created = control_type::template make_array<char>(
+                        capacity + 1u, unfinished);
+                std::char_traits<char>::copy(created.second, start, used);
+                control_type::decrement(owner);
+                owner = created.first.release();
+                start = created.second;
+                space = capacity;
+            }
+            /// Make room for `count` more code units, growing geometrically
+            char *extend(std::size_t const count) {
+                if (space - used < count) {
+                    reallocate(std::max(
+                            {used + count, 2u * space, minimum_capacity}));
+                }
+                return start + used;
+            }
+
+          public:
+            /// The smallest allocation made when appending
+            static constexpr std::size_t minimum_capacity = 64u;
+
+
+            /// ## Constructors
+            u8string_builder() noexcept {}
+            explicit u8string_builder(std::size_t const capacity) {
+                reserve(capacity);
+            }
+
+            u8string_builder(u8string_builder const &) = delete;
+            u8string_builder(u8string_builder &&b) noexcept
+            : owner{std::exchange(b.owner, nullptr)},
+              start{std::exchange(b.start, nullptr)},
+              used{std::exchange(b.used, 0u)},
+              space{std::exchange(b.space, 0u)} {}
+            u8string_builder &operator=(u8string_builder const &) = delete;
+            u8string_builder &operator=(u8string_builder &&b) noexcept {
+                control_type::decrement(owner);
+                owner = std::exchange(b.owner, nullptr);
+                start = std::exchange(b.start, nullptr);
+                used = std::exchange(b.used, 0u);
+                space = std::exchange(b.space, 0u);
+                return *this;
+            }
+            ~u8string_builder() { control_type::decrement(owner); }
+
+
+            /// ## Capacity
+
+            /// Make sure there is room for at least `capacity` code units
+            /// in total without moving to a new allocation
+            void reserve(std::size_t const capacity) {
+                if (capacity > space) reallocate(capacity);
+            }
+            std::size_t capacity() const noexcept { return space; }
+
+            /// Return the number of code units written so far
+            std::size_t code_units() const noexcept { return used; }
+            std::size_t bytes() const noexcept { return used; }
+            bool empty() const noexcept { return used == 0u; }
+
+
+            /// ## Appending
+
+            u8string_builder &append(u8view const v) {
+                auto const out = extend(v.code_units());
+                std::char_traits<char>::copy(out, v.data(), v.code_units());
+                used += v.code_units();
+                return *this;
+            }
+            /// Append a code point. An invalid code point raises an error
+            /// of type `E`, or appends U+FFFD if `E` is `void`.
+            template<typename E = std::domain_error>
+            u8string_builder &append(utf32 const cp) {
+                auto const valid = return_valid<E>(cp);
+                used += detail::u8write(valid, extend(4u));
+                return *this;
+            }
+            /// Append the output of `std::snprintf`, which writes straight
+            /// into the buffer. The caller is responsible for the result
+            /// being valid UTF-8.
+            template<typename... Args>
+            u8string_builder &
+                    append_formatted(char const *const format, Args... args) {
+                /// Try first in the space left (which may be none)
+                auto const available = space - used;
+                auto const wanted = std::snprintf(
+                        start ? start + used : nullptr,
+                        start ? available + 1u : 0u, format, args...);
+                if (wanted < 0) {
+                    raise<std::invalid_argument>("Formatting failed");
+                } else if (std::size_t(wanted) > available) {
+                    auto const out = extend(wanted);
+                    std::snprintf(out, wanted + 1u, format, args...);
+                }
+                used += wanted;
+                return *this;
+            }
+
+
+            /// ## Hand-off
+
+            /// A string holding everything appended so far. Long strings
+            /// share the builder's allocation.
+            u8string snapshot() const {
+                return u8string{
+                        u8view{u8view::buffer_type{start, used}, owner}};
+            }
+
+            /// Turn the content into a `u8string`. The allocation (and so
+            /// the code units) is handed to the string without being
+            /// copied, unless the string is short enough to be inline. The
+            /// builder is left empty.
+            u8string finish() {
+                if (not owner) return {};
+                start[used] = '\0';
+                /// Snapshots on other threads may be reading `user_data`.
+                /// Without them no other thread can have the block, and
+                /// none can get it until `finish` returns.
+                if (control_type::owners(owner) == 1u) {
+                    owner->user_data = used;
+                }
+                auto s = snapshot();
+                *this = u8string_builder{};
+                return s;
+            }
+        };
+
+
+    }
+
+
+    using u8string_builder = cord::u8string_builder;
+
+
+}
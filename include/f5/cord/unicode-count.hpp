@@ -0,0 +1,203 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/cord/simd.hpp>
+#include <f5/cord/unicode-core.hpp>
+
+#include <algorithm>
+#include <vector>
+
+
+namespace f5 {
+
+
+    namespace cord {
+
+
+        namespace detail {
+
+
+            /// Count the UTF-8 continuation bytes (`10xxxxxx`) in a word. The
+            /// shift moves bit 6 of each byte into the bit 7 position.
+            constexpr inline std::size_t
+                    u8continuations(std::uint64_t const w) noexcept {
+                return simd::popcount(w & ~(w << 1) & 0x8080'8080'8080'8080u);
+            }
+
+
+            inline std::size_t
+                    u8count(char const *const s, std::size_t const size) noexcept {
+                std::size_t count{}, pos{};
+#if defined(F5_CORD_SIMD_SSE42)
+                using V = simd::native;
+                /// Continuation bytes are the only ones at or below -65
+                /// when treated as signed
+                auto const threshold = V::splat(0xbf);
+                for (; size - pos >= V::width; pos += V::width) {
+                    count += simd::popcount(
+                            V::greater(V::load(s + pos), threshold));
+                }
+#endif
+                for (; size - pos >= 8u; pos += 8u) {
+                    count += 8u - u8continuations(simd::load64(s + pos));
+                }
+                for (; pos < size; ++pos) {
+                    if ((static_cast<unsigned char>(s[pos]) & 0xc0) != 0x80) {
+                        ++count;
+                    }
+                }
+                return count;
+            }
+
+
+            /// The offset of the code point `n` code points into the
+            /// buffer, or its size if there are fewer. The buffer must start
+            /// on a code point boundary, and like counting the encoding is
+            /// not checked.
+            inline std::size_t u8skip(
+                    char const *const s,
+                    std::size_t const size,
+                    std::size_t n) noexcept {
+                std::size_t pos{};
+                for (; size - pos >= 8u; pos += 8u) {
+                    auto const leads =
+                            8u - u8continuations(simd::load64(s + pos));
+                    if (leads > n) break;
+                    n -= leads;
+                }
+                for (; pos < size; ++pos) {
+                    if ((static_cast<unsigned char>(s[pos]) & 0xc0) != 0x80) {
+                        if (n == 0u) return pos;
+                        --n;
+                    }
+                }
+                return size;
+            }
+
+
+            inline std::size_t u16count(
+                    utf16 const *const s, std::size_t const size) noexcept {
+                std::size_t trailing{}, pos{};
+#if defined(F5_CORD_SIMD_SSE42)
+                using V = simd::native;
+                auto const top = V::splat16(0xfc00), low = V::splat16(0xdc00);
+                for (; size - pos >= V::width / 2; pos += V::width / 2) {
+                    trailing += simd::popcount(V::equal16(
+                                        V::bit_and(V::load(s + pos), top), low))
+                            / 2u;
+                }
+#endif
+                for (; pos < size; ++pos) {
+                    if ((s[pos] & 0xfc00) == 0xdc00) ++trailing;
+                }
+                return size - trailing;
+            }
+
+
+        }
+
+
+        /// ## Counting
+
+        /// Return the number of code points in the buffer. This works
+        /// directly on the code units: the UTF-8 continuation bytes and
+        /// trailing UTF-16 surrogates are not counted. For valid data the
+        /// result is the same as the number of iterations, but unlike
+        /// iteration the encoding is not checked.
+        inline std::size_t count_code_points(const_u8buffer const b) noexcept {
+            return detail::u8count(b.data(), b.size());
+        }
+        inline std::size_t count_code_points(const_u16buffer const b) noexcept {
+            return detail::u16count(b.data(), b.size());
+        }
+        constexpr inline std::size_t
+                count_code_points(const_u32buffer const b) noexcept {
+            return b.size();
+        }
+
+
+        namespace detail {
+
+
+            /**
+                A sparse index from code point positions to where they are
+                in a block of UTF-8, with a checkpoint every `every` code
+                points. Finding a code point, or the position of one, is a
+                binary search followed by a walk of fewer than `every` code
+                points. Blocks that are all ASCII don't need checkpoints.
+             */
+            class u8index {
+                char const *base;
+                std::size_t size, count = {};
+                std::vector<std::size_t> checkpoints;
+
+              public:
+                static constexpr std::size_t every = 256u;
+
+                u8index(char const *const b, std::size_t const s)
+                : base{b}, size{s} {
+                    if (simd::ascii_length(base, size) == size) {
+                        count = size;
+                        return;
+                    }
+                    checkpoints.reserve(size / every + 1u);
+                    for (std::size_t offset{}; offset < size;) {
+                        checkpoints.push_back(offset);
+                        offset += u8skip(base + offset, size - offset, every);
+                    }
+                    if (not checkpoints.empty()) {
+                        auto const last = checkpoints.back();
+                        count = (checkpoints.size() - 1u) * every
+                                + u8count(base + last, size - last);
+                    }
+                }
+
+                /// Return `true` if the pointer is within the indexed block
+                bool covers(char const *const p) const noexcept {
+                    return p >= base && p <= base + size;
+                }
+                /// The number of code points in the block
+                std::size_t code_points() const noexcept { return count; }
+
+                /// The number of the code point starting at `p`
+                std::size_t position(char const *const p) const noexcept {
+                    std::size_t const offset = p - base;
+                    if (checkpoints.empty()) return offset;
+                    auto const k = std::size_t(
+                            std::upper_bound(
+                                    checkpoints.begin(), checkpoints.end(),
+                                    offset)
+                            - checkpoints.begin() - 1);
+                    return k * every
+                            + u8count(base + checkpoints[k],
+                                      offset - checkpoints[k]);
+                }
+                /// Where code point `cp` starts, or the end of the block
+                char const *at(std::size_t const cp) const noexcept {
+                    if (cp >= count) {
+                        return base + size;
+                    } else if (checkpoints.empty()) {
+                        return base + cp;
+                    }
+                    auto const from = checkpoints[cp / every];
+                    return base + from
+                            + u8skip(base + from, size - from, cp % every);
+                }
+            };
+
+
+        }
+
+
+    }
+
+
+}
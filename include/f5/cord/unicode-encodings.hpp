@@ -26,15 +26,16 @@ namespace f5 {
         template<typename E = std::domain_error>
         constexpr inline bool check_valid(utf32 cp) {
             if (cp >= 0xd800 && cp <= 0xdbff) {
-                raise<E>(
+                raise_encoding<E>(
                         "UTF32 code point is in the leading UTF16 surrogate "
                         "pair range");
             } else if (cp >= 0xdc00 && cp <= 0xdfff) {
-                raise<E>(
+                raise_encoding<E>(
                         "UTF32 code point is in the trailing UTF16 surrogate "
                         "pair range");
             } else if (cp > 0x10ffff) {
-                raise<E>("UTF32 code point is beyond the allowable range");
+                raise_encoding<E>(
+                        "UTF32 code point is beyond the allowable range");
             } else {
                 return true;
             }
@@ -44,15 +45,16 @@ namespace f5 {
         template<typename E = std::domain_error>
         constexpr inline utf32 return_valid(utf32 cp) {
             if (cp >= 0xd800 && cp <= 0xdbff) {
-                raise<E>(
+                raise_encoding<E>(
                         "UTF32 code point is in the leading UTF16 surrogate "
                         "pair range");
             } else if (cp >= 0xdc00 && cp <= 0xdfff) {
-                raise<E>(
+                raise_encoding<E>(
                         "UTF32 code point is in the trailing UTF16 surrogate "
                         "pair range");
             } else if (cp > 0x10ffff) {
-                raise<E>("UTF32 code point is beyond the allowable range");
+                raise_encoding<E>(
+                        "UTF32 code point is beyond the allowable range");
             } else {
                 return cp;
             }
@@ -102,7 +104,7 @@ namespace f5 {
                           static_cast<utf8>(0x80 | ((cp >> 6) & 0x3f)),
                           static_cast<utf8>(0x80 | (cp & 0x3f))}}};
             default:
-                raise<E>("Cannot encode an invalid UTF32 code point ");
+                raise_encoding<E>("Cannot encode an invalid UTF32 code point ");
                 return {0u, {{0u, 0u, 0u, 0u}}};
             }
         }
@@ -116,7 +118,8 @@ namespace f5 {
             if (ch < 0x80)
                 return 1u;
             else if (ch >= 0x80 && ch <= 0xBF)
-                raise<E>("UTF8 continuation byte found in lead position");
+                raise_encoding<E>(
+                        "UTF8 continuation byte found in lead position");
             else if (ch >= 0xC0 && ch < 0xE0)
                 return 2u;
             else if (ch >= 0xE0 && ch < 0xF0)
@@ -124,11 +127,13 @@ namespace f5 {
             else if (ch >= 0xF0 && ch < 0xF8)
                 return 4u;
             else if (ch >= 0xF8 && ch < 0xFC)
-                raise<E>("UTF8 control byte may not imply five byte sequence");
+                raise_encoding<E>(
+                        "UTF8 control byte may not imply five byte sequence");
             else if (ch >= 0xFC && ch < 0xFE)
-                raise<E>("UTF8 control byte may not imply six byte sequence");
+                raise_encoding<E>(
+                        "UTF8 control byte may not imply six byte sequence");
             else
-                raise<E>("Invalid UTF8 byte value 0xFF");
+                raise_encoding<E>("Invalid UTF8 byte value 0xFF");
             return 0u;
         }
 
@@ -194,7 +199,8 @@ namespace f5 {
             if (length == 1) {
                 return {1, {{static_cast<utf16>(cp), 0u}}};
             } else if (length == 0) {
-                raise<E>("Cannot convert an invalid code point to UTF-16");
+                raise_encoding<E>(
+                        "Cannot convert an invalid code point to UTF-16");
                 return {0, {{0, 0}}};
             } else {
                 return {2,
@@ -0,0 +1,167 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/cord/unicode-string.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+
+namespace f5 {
+
+
+    namespace cord {
+
+
+        namespace detail {
+
+
+            __extension__ typedef unsigned __int128 hash_wide;
+
+            /// Multiply, folding the high half of the 128 bit product into
+            /// the low half
+            inline std::uint64_t
+                    hash_mix(std::uint64_t const a, std::uint64_t const b) noexcept {
+                auto const r = static_cast<hash_wide>(a) * b;
+                return static_cast<std::uint64_t>(r)
+                        ^ static_cast<std::uint64_t>(r >> 64u);
+            }
+            inline std::uint64_t hash_load32(unsigned char const *p) noexcept {
+                std::uint32_t w;
+                std::memcpy(&w, p, sizeof(w));
+                return w;
+            }
+
+            constexpr std::uint64_t hash_keys[] = {
+                    0xa076'1d64'78bd'642fu, 0xe703'7ed1'a0b4'28dbu,
+                    0x8ebc'6af0'9c88'c6e3u, 0x5899'65cc'7537'4cc3u};
+
+            /**
+                A 64 bit hash of a block of memory. It is in the style of
+                wyhash: blocks of 16 bytes are mixed by a 64x64 to 128 bit
+                multiply, and longer inputs are handled 48 bytes at a
+                time with three independent multiply chains so that they
+                can run in parallel.
+             */
+            inline std::uint64_t hash_bytes(
+                    void const *const data,
+                    std::size_t const size,
+                    std::uint64_t seed = 0u) noexcept {
+                auto p = static_cast<unsigned char const *>(data);
+                seed ^= hash_mix(seed ^ hash_keys[0], hash_keys[1]);
+                std::uint64_t a{}, b{};
+                if (size <= 16u) {
+                    if (size >= 4u) {
+                        auto const step = (size >> 3u) << 2u;
+                        a = (hash_load32(p) << 32u) | hash_load32(p + step);
+                        b = (hash_load32(p + size - 4u) << 32u)
+                                | hash_load32(p + size - 4u - step);
+                    } else if (size) {
+                        a = (std::uint64_t{p[0]} << 16u)
+                                | (std::uint64_t{p[size >> 1u]} << 8u)
+                                | p[size - 1u];
+                    }
+                } else {
+                    auto left = size;
+                    if (left > 48u) {
+                        auto s1 = seed, s2 = seed;
+                        do {
+                            seed = hash_mix(
+                                    simd::load64(p) ^ hash_keys[1],
+                                    simd::load64(p + 8) ^ seed);
+                            s1 = hash_mix(
+                                    simd::load64(p + 16) ^ hash_keys[2],
+                                    simd::load64(p + 24) ^ s1);
+                            s2 = hash_mix(
+                                    simd::load64(p + 32) ^ hash_keys[3],
+                                    simd::load64(p + 40) ^ s2);
+                            p += 48u;
+                            left -= 48u;
+                        } while (left > 48u);
+                        seed ^= s1 ^ s2;
+                    }
+                    while (left > 16u) {
+                        seed = hash_mix(
+                                simd::load64(p) ^ hash_keys[1],
+                                simd::load64(p + 8) ^ seed);
+                        p += 16u;
+                        left -= 16u;
+                    }
+                    a = simd::load64(p + left - 16u);
+                    b = simd::load64(p + left - 8u);
+                }
+                auto const r = static_cast<hash_wide>(a ^ hash_keys[1])
+                        * (b ^ seed);
+                return hash_mix(
+                        static_cast<std::uint64_t>(r) ^ hash_keys[0] ^ size,
+                        static_cast<std::uint64_t>(r >> 64u) ^ hash_keys[1]);
+            }
+
+
+        }
+
+
+        /// ## Hashing
+
+        /// A 64 bit hash of the code units. Equal strings of the same
+        /// encoding always have the same hash.
+        template<typename C, typename E, typename IM, typename R>
+        inline std::uint64_t hash(basic_view<C, E, IM, R> const v) noexcept {
+            return detail::hash_bytes(v.data(), v.bytes());
+        }
+        /// When `F5_CORD_HASH_CACHE` is defined the hash of a string that
+        /// covers everything in its allocation is kept in the control block,
+        /// so it is only worked out once.
+        template<typename C, typename V>
+        inline std::uint64_t hash(basic_string<C, V> const &s) noexcept {
+#if defined(F5_CORD_HASH_CACHE)
+            if (auto const c = s.control_block();
+                c && c->user_data == s.code_units()) {
+                if (auto const h =
+                            c->user_data.hash.load(std::memory_order_relaxed)) {
+                    return h;
+                }
+                auto const h = detail::hash_bytes(s.data(), s.bytes());
+                c->user_data.hash.store(h, std::memory_order_relaxed);
+                return h;
+            }
+#endif
+            return detail::hash_bytes(s.data(), s.bytes());
+        }
+
+
+    }
+
+
+}
+
+
+namespace std {
+
+
+    template<typename C, typename E, typename IM, typename R>
+    struct hash<f5::cord::basic_view<C, E, IM, R>> {
+        std::size_t
+                operator()(f5::cord::basic_view<C, E, IM, R> const v) const noexcept {
+            return f5::cord::hash(v);
+        }
+    };
+    template<typename C, typename V>
+    struct hash<f5::cord::basic_string<C, V>> {
+        std::size_t operator()(f5::cord::basic_string<C, V> const &s) const
+                noexcept {
+            return f5::cord::hash(s);
+        }
+    };
+
+
+}
@@ -10,8 +10,10 @@
 
 
 #include <f5/control.hpp>
+#include <f5/cord/simd.hpp>
 #include <f5/cord/unicode-encodings.hpp>
 
+#include <algorithm>
 #include <tuple>
 
 
@@ -21,24 +23,30 @@ namespace f5 {
     namespace cord {
 
 
-        /// An iterator that produces UTF-32 from a UTF-16 iterator
+        /// An iterator that produces UTF-32 from a UTF-16 iterator. It
+        /// remembers where the sequence starts so that it can be moved
+        /// backwards safely.
         template<typename U16, typename E = std::range_error>
         class const_u16u32_iterator :
         public std::iterator<
-                std::forward_iterator_tag,
+                std::bidirectional_iterator_tag,
                 utf32,
                 std::ptrdiff_t,
                 const utf32 *,
                 utf32> {
-            U16 pos, end;
+            U16 first, pos, end;
 
           public:
             /// Default construct
-            constexpr const_u16u32_iterator() noexcept : pos{}, end{} {}
+            constexpr const_u16u32_iterator() noexcept
+            : first{}, pos{}, end{} {}
 
             /// Construct from a begin and end pair
             constexpr const_u16u32_iterator(U16 b, U16 e) noexcept
-            : pos{std::move(b)}, end{std::move(e)} {}
+            : first{b}, pos{std::move(b)}, end{std::move(e)} {}
+            /// Construct at a position part way through a sequence
+            constexpr const_u16u32_iterator(U16 f, U16 p, U16 e) noexcept
+            : first{std::move(f)}, pos{std::move(p)}, end{std::move(e)} {}
 
             /// Increment position
             constexpr const_u16u32_iterator &operator++() {
@@ -48,7 +56,23 @@ namespace f5 {
             }
             constexpr const_u16u32_iterator operator++(int) {
                 auto ret = *this;
-                pos++;
+                ++(*this);
+                return ret;
+            }
+            /// Decrement position. A trailing surrogate is only stepped
+            /// over together with the leading one before it.
+            constexpr const_u16u32_iterator &operator--() {
+                --pos;
+                if (pos != first && (*pos & 0xfc00) == 0xdc00) {
+                    auto previous = pos;
+                    --previous;
+                    if ((*previous & 0xfc00) == 0xd800) pos = previous;
+                }
+                return *this;
+            }
+            constexpr const_u16u32_iterator operator--(int) {
+                auto ret = *this;
+                --(*this);
                 return ret;
             }
 
@@ -58,7 +82,8 @@ namespace f5 {
                     auto next = pos;
                     ++next;
                     if (next == end) {
-                        raise<E>("Truncated surrogate pair in UTF-16 sequence");
+                        raise_encoding<E>(
+                                "Truncated surrogate pair in UTF-16 sequence");
                         return 0;
                     } else {
                         return u16decode(*pos, *next);
@@ -178,10 +203,13 @@ namespace f5 {
         }
 
 
+        /// An iterator that produces UTF-32 from UTF-8. `buffer` is
+        /// what is left to iterate over and `first` is where the sequence
+        /// starts, so that it can be moved backwards safely.
         template<typename B, typename E = std::range_error>
         struct const_u8u32_iterator :
         public std::iterator<
-                std::forward_iterator_tag,
+                std::bidirectional_iterator_tag,
                 utf32,
                 std::ptrdiff_t,
                 const utf32 *,
@@ -189,16 +217,30 @@ namespace f5 {
             using buffer_type = B;
 
             buffer_type buffer;
+            typename buffer_type::pointer_const_type first = nullptr;
 
             constexpr const_u8u32_iterator() {}
 
             constexpr explicit const_u8u32_iterator(buffer_type b) noexcept
-            : buffer(std::move(b)) {}
+            : buffer(std::move(b)), first{buffer.data()} {}
+            /// Construct at `offset` code units into the buffer
+            constexpr const_u8u32_iterator(
+                    buffer_type b, std::size_t const offset) noexcept
+            : buffer{b.slice(offset)}, first{b.data()} {}
 
+            /// ASCII is handled without going through the decoder
             constexpr utf32 operator*() const {
-                return decode_one<E>(buffer).first;
+                if (is_ascii()) {
+                    return buffer[0];
+                } else {
+                    return decode_one<E>(buffer).first;
+                }
             }
             constexpr const_u8u32_iterator &operator++() {
+                if (is_ascii()) {
+                    buffer = buffer_type{buffer.data() + 1, buffer.size() - 1};
+                    return *this;
+                }
                 const auto here = **this;
                 const auto bytes = u8length<E>(here);
                 buffer = buffer.slice(bytes);
@@ -209,6 +251,34 @@ namespace f5 {
                 ++(*this);
                 return ret;
             }
+            /// Step back over at most three continuation bytes to the
+            /// start of the previous code point
+            constexpr const_u8u32_iterator &operator--() {
+                auto p = buffer.data() - 1;
+                if (static_cast<unsigned char>(*p) >= 0x80) {
+                    auto const limit =
+                            p - std::min(std::ptrdiff_t{3}, p - first);
+                    while (p != limit
+                           && (static_cast<unsigned char>(*p) & 0xc0) == 0x80) {
+                        --p;
+                    }
+                    if (u8codepoint_length<E>(*p)
+                        != std::size_t(buffer.data() - p)) {
+                        raise_encoding<E>(
+                                "Invalid UTF8 sequence found when moving "
+                                "backwards");
+                        p = buffer.data() - 1;
+                    }
+                }
+                buffer = buffer_type{
+                        p, buffer.size() + std::size_t(buffer.data() - p)};
+                return *this;
+            }
+            constexpr const_u8u32_iterator operator--(int) {
+                const_u8u32_iterator ret{*this};
+                --(*this);
+                return ret;
+            }
 
             constexpr bool operator==(const_u8u32_iterator it) const noexcept {
                 return buffer.data() == it.buffer.data();
@@ -216,6 +286,12 @@ namespace f5 {
             constexpr bool operator!=(const_u8u32_iterator it) const noexcept {
                 return buffer.data() != it.buffer.data();
             }
+
+          private:
+            constexpr bool is_ascii() const noexcept {
+                return buffer.size()
+                        && static_cast<unsigned char>(buffer[0]) < 0x80;
+            }
         };
 
 
@@ -244,7 +320,17 @@ namespace f5 {
             constexpr static auto make_iterator(
                     Buffer b, std::add_pointer_t<Control> o) noexcept {
                 return u32iter<Buffer, Control>{
-                        const_u8u32_iterator<Buffer>{b}, o};
+                        const_u8u32_iterator<Buffer, E>{b}, o};
+            }
+            /// An iterator `offset` code units in that can still be moved
+            /// back to the start of the buffer
+            template<typename Buffer, typename Control>
+            constexpr static auto make_iterator(
+                    Buffer b,
+                    std::size_t const offset,
+                    std::add_pointer_t<Control> o) noexcept {
+                return u32iter<Buffer, Control>{
+                        const_u8u32_iterator<Buffer, E>{b, offset}, o};
             }
             template<typename Buffer, typename Control>
             constexpr static auto make_u16iterator(
@@ -263,6 +349,25 @@ namespace f5 {
                                 - s.iterator.buffer.data())};
             }
 
+            /// Move the iterator forward by up to `n` code points. Runs of
+            /// ASCII are stepped over in bulk.
+            template<typename Iterator>
+            static void
+                    advance(Iterator &pos, Iterator const end, std::size_t n) {
+                auto &buffer = pos.iterator.buffer;
+                while (n && pos != end) {
+                    auto const run = simd::ascii_length(
+                            buffer.data(), std::min(n, buffer.size()));
+                    if (run) {
+                        buffer = buffer.slice(run);
+                        n -= run;
+                    } else {
+                        ++pos;
+                        --n;
+                    }
+                }
+            }
+
             static auto encode_one(utf32 const c) { return u8encode(c); }
         };
 
@@ -283,11 +388,21 @@ namespace f5 {
             static constexpr auto
                     make_iterator(Buffer b, std::add_pointer_t<Control> o) {
                 return u32iter<Buffer, Control>{
-                        const_u16u32_iterator<u16iter<Buffer, Control>>{
+                        const_u16u32_iterator<u16iter<Buffer, Control>, E>{
                                 b.begin(), b.end()},
                         o};
             }
             template<typename Buffer, typename Control>
+            static constexpr auto make_iterator(
+                    Buffer b,
+                    std::size_t const offset,
+                    std::add_pointer_t<Control> o) {
+                return u32iter<Buffer, Control>{
+                        const_u16u32_iterator<u16iter<Buffer, Control>, E>{
+                                b.begin(), b.begin() + offset, b.end()},
+                        o};
+            }
+            template<typename Buffer, typename Control>
             static constexpr auto make_u16iterator(
                     u32iter<Buffer, Control> b,
                     u32iter<Buffer, Control>) noexcept {
@@ -304,6 +419,13 @@ namespace f5 {
                                 - s.iterator.u16_iterator())};
             }
 
+            /// Move the iterator forward by up to `n` code points
+            template<typename Iterator>
+            static void
+                    advance(Iterator &pos, Iterator const end, std::size_t n) {
+                for (; n && pos != end; --n) ++pos;
+            }
+
             static auto encode_one(utf32 const c) { return u16encode(c); }
         };
 
@@ -327,6 +449,13 @@ namespace f5 {
                 return u32iter<Buffer, Control>{b.begin(), o};
             }
             template<typename Buffer, typename Control>
+            static constexpr auto make_iterator(
+                    Buffer b,
+                    std::size_t const offset,
+                    std::add_pointer_t<Control> o) {
+                return u32iter<Buffer, Control>{b.begin() + offset, o};
+            }
+            template<typename Buffer, typename Control>
             static constexpr auto make_u16iterator(
                     u32iter<Buffer, Control> b, u32iter<Buffer, Control> e) {
                 return u16iter<Buffer, Control>{b.iterator, e.iterator};
@@ -338,6 +467,14 @@ namespace f5 {
                 return Buffer{s.iterator, std::size_t(e.iterator - s.iterator)};
             }
 
+            /// Move the iterator forward by up to `n` code points
+            template<typename Iterator>
+            static void
+                    advance(Iterator &pos, Iterator const end, std::size_t n) {
+                pos.iterator += std::min(
+                        n, std::size_t(end.iterator - pos.iterator));
+            }
+
             static std::pair<char, std::array<char32_t, 1>>
                     encode_one(utf32 const c) {
                 return {1, {c}};
@@ -0,0 +1,159 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/cord/unicode-string.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+
+namespace f5 {
+
+
+    namespace cord {
+
+
+        /// ## Retention
+        /**
+            How much memory strings keep alive compared to how much of it
+            they use. A short substring of a long string shares its
+            allocation, so all of it stays alive until the substring is
+            released, copied by `shrink_to_fit` or moved by `compact`.
+
+            `referenced` is the bytes of the allocation that the strings use
+            (counting bytes that several of them use once), and `retained`
+            the size of the allocation. Inline strings and literals retain
+            nothing. Allocations that don't record their size, like those
+            of an unfinished `u8string_builder`, are taken to retain only
+            what is referenced.
+         */
+        struct retained_bytes {
+            /// The control block of the allocation, or `nullptr` for the
+            /// strings that have none
+            void const *block = nullptr;
+            std::size_t strings = {}, referenced = {}, retained = {};
+
+            /// The bytes kept alive that none of the strings use
+            std::size_t unused() const noexcept {
+                return retained > referenced ? retained - referenced : 0u;
+            }
+        };
+
+
+        /// The retention of a single string
+        template<typename C, typename V>
+        inline retained_bytes retention(basic_string<C, V> const &s) {
+            auto const block = s.is_inline() ? nullptr : s.control_block();
+            retained_bytes r{block, 1u, s.memory().size(), {}};
+            if (block) {
+                std::size_t const allocated = block->user_data;
+                r.retained = allocated == basic_string<C, V>::npos
+                        ? r.referenced
+                        : std::max(allocated * sizeof(C), r.referenced);
+            } else {
+                r.referenced = 0u;
+            }
+            return r;
+        }
+
+
+        /**
+            The retention of each allocation used by the strings, with those
+            keeping the most unused bytes alive first. Other strings and
+            views may also be using the allocations, so these are upper
+            bounds for what releasing or compacting the strings would save.
+         */
+        template<typename R>
+        inline std::vector<retained_bytes>
+                retention_by_block(R const &strings) {
+            struct part {
+                void const *block;
+                char const *start, *end;
+            };
+            std::vector<part> parts;
+            std::vector<retained_bytes> blocks;
+            for (auto const &s : strings) {
+                auto const r = retention(s);
+                if (not r.block) continue;
+                auto const memory = s.memory();
+                auto const start = reinterpret_cast<char const *>(
+                        memory.data());
+                parts.push_back({r.block, start, start + memory.size()});
+                blocks.push_back(r);
+            }
+            std::sort(parts.begin(), parts.end(), [](auto &l, auto &r) {
+                return std::less<>{}(l.block, r.block)
+                        || (l.block == r.block
+                            && std::less<>{}(l.start, r.start));
+            });
+            std::sort(blocks.begin(), blocks.end(), [](auto &l, auto &r) {
+                return std::less<>{}(l.block, r.block);
+            });
+            blocks.erase(
+                    std::unique(
+                            blocks.begin(), blocks.end(),
+                            [](auto &l, auto &r) {
+                                return l.block == r.block;
+                            }),
+                    blocks.end());
+
+            /// The parts of each block are in order, so overlaps are next
+            /// to each other
+            auto p = parts.begin();
+            for (auto &b : blocks) {
+                b.strings = 0u;
+                std::size_t referenced{};
+                char const *covered = nullptr;
+                for (; p != parts.end() && p->block == b.block; ++p) {
+                    ++b.strings;
+                    auto const from =
+                            covered ? std::max(p->start, covered) : p->start;
+                    if (p->end > from) {
+                        referenced += p->end - from;
+                        covered = p->end;
+                    }
+                }
+                /// Blocks of unknown size were given the size of a single
+                /// string
+                b.retained = std::max(b.retained, referenced);
+                b.referenced = referenced;
+            }
+            std::stable_sort(
+                    blocks.begin(), blocks.end(), [](auto &l, auto &r) {
+                        return l.unused() > r.unused();
+                    });
+            return blocks;
+        }
+
+
+        /**
+            Move long-lived strings out of the allocations they are keeping
+            alive. The strings that use only part of their allocation are
+            copied together into a single allocation that holds just them.
+            Strings that already fill their allocation between them are
+            left where they are. Returns how many strings were moved.
+
+                f5::cord::compact(cache_keys);
+         */
+        template<typename R>
+        inline std::size_t compact(R &strings) {
+            using string_type = std::remove_reference_t<
+                    decltype(*std::begin(strings))>;
+            return string_type::rehome(strings);
+        }
+
+
+    }
+
+
+}
@@ -0,0 +1,412 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/cord/simd.hpp>
+#include <f5/cord/unicode-encodings.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+
+
+namespace f5 {
+
+
+    namespace cord {
+
+
+        /**
+            Searching works directly on the code units of any of the
+            encodings. As the first code unit of a code point can never be
+            mistaken for part of another one, a match of valid code units
+            always starts and ends on code point boundaries.
+         */
+        namespace detail {
+
+
+            inline constexpr std::size_t search_npos =
+                    std::numeric_limits<std::size_t>::max();
+
+
+#if defined(F5_CORD_SIMD_SSE42)
+            /// Comparisons of vectors of code units. The masks have one bit
+            /// for each byte, and only the lowest of the bits for each code
+            /// unit is kept.
+            template<typename C>
+            inline simd::native::vector splat_unit(C const c) noexcept {
+                using V = simd::native;
+                if constexpr (sizeof(C) == 1) {
+                    return V::splat(static_cast<std::uint8_t>(c));
+                } else if constexpr (sizeof(C) == 2) {
+                    return V::splat16(c);
+                } else {
+                    return V::splat32(c);
+                }
+            }
+            template<typename C>
+            inline std::uint64_t equal_units(
+                    simd::native::vector const l,
+                    simd::native::vector const r) noexcept {
+                using V = simd::native;
+                if constexpr (sizeof(C) == 1) {
+                    return V::equal(l, r);
+                } else if constexpr (sizeof(C) == 2) {
+                    return V::equal16(l, r) & 0x5555'5555'5555'5555u;
+                } else {
+                    return V::equal32(l, r) & 0x1111'1111'1111'1111u;
+                }
+            }
+#endif
+
+
+            /// The offset of the first code unit equal to `c`
+            template<typename C>
+            inline std::size_t find_unit(
+                    C const *const s,
+                    std::size_t const size,
+                    C const c) noexcept {
+                std::size_t pos{};
+#if defined(F5_CORD_SIMD_SSE42)
+                using V = simd::native;
+                constexpr std::size_t step = V::width / sizeof(C);
+                auto const needle = splat_unit(c);
+                for (; size - pos >= step; pos += step) {
+                    if (auto const m =
+                                equal_units<C>(V::load(s + pos), needle)) {
+                        return pos + simd::lowest(m) / sizeof(C);
+                    }
+                }
+#endif
+                if constexpr (sizeof(C) == 1) {
+                    if (auto const f = std::memchr(s + pos, c, size - pos)) {
+                        return static_cast<C const *>(f) - s;
+                    }
+                } else {
+                    for (; pos < size; ++pos) {
+                        if (s[pos] == c) return pos;
+                    }
+                }
+                return search_npos;
+            }
+            /// The offset of the last code unit equal to `c`
+            template<typename C>
+            inline std::size_t rfind_unit(
+                    C const *const s, std::size_t size, C const c) noexcept {
+#if defined(F5_CORD_SIMD_SSE42)
+                using V = simd::native;
+                constexpr std::size_t step = V::width / sizeof(C);
+                auto const needle = splat_unit(c);
+                for (; size >= step; size -= step) {
+                    if (auto const m = equal_units<C>(
+                                V::load(s + size - step), needle)) {
+                        return size - step + simd::highest(m) / sizeof(C);
+                    }
+                }
+#endif
+                while (size) {
+                    if (s[--size] == c) return size;
+                }
+                return search_npos;
+            }
+            /// The number of code units equal to `c`
+            template<typename C>
+            inline std::size_t count_unit(
+                    C const *const s,
+                    std::size_t const size,
+                    C const c) noexcept {
+                std::size_t count{}, pos{};
+#if defined(F5_CORD_SIMD_SSE42)
+                using V = simd::native;
+                constexpr std::size_t step = V::width / sizeof(C);
+                auto const needle = splat_unit(c);
+                for (; size - pos >= step; pos += step) {
+                    count += simd::popcount(
+                            equal_units<C>(V::load(s + pos), needle));
+                }
+#endif
+                for (; pos < size; ++pos) {
+                    if (s[pos] == c) ++count;
+                }
+                return count;
+            }
+
+
+            /**
+                The offset of the first place the needle `n` appears. Long
+                needles are found by checking both their first and last code
+                units against a vector of starting positions at once. Only
+                the places where both match have the rest of the needle
+                compared, which skips nearly everything in ordinary text.
+             */
+            template<typename C>
+            inline std::size_t find_units(
+                    C const *const s,
+                    std::size_t const size,
+                    C const *const n,
+                    std::size_t const m) noexcept {
+                if (m == 0u) {
+                    return 0u;
+                } else if (m > size) {
+                    return search_npos;
+                } else if (m == 1u) {
+                    return find_unit(s, size, n[0]);
+                }
+                auto const rest = (m - 1u) * sizeof(C);
+                /// The number of places the needle could start
+                auto const starts = size - m + 1u;
+                std::size_t pos{};
+#if defined(F5_CORD_SIMD_SSE42)
+                using V = simd::native;
+                constexpr std::size_t step = V::width / sizeof(C);
+                auto const first = splat_unit(n[0]),
+                           last = splat_unit(n[m - 1u]);
+                for (; starts - pos >= step; pos += step) {
+                    auto mask = equal_units<C>(V::load(s + pos), first)
+                            & equal_units<C>(V::load(s + pos + m - 1u), last);
+                    for (; mask; mask &= mask - 1u) {
+                        auto const at = pos + simd::lowest(mask) / sizeof(C);
+                        if (std::memcmp(s + at + 1u, n + 1u, rest) == 0) {
+                            return at;
+                        }
+                    }
+                }
+#endif
+                while (pos < starts) {
+                    auto const f = find_unit(s + pos, starts - pos, n[0]);
+                    if (f == search_npos) return search_npos;
+                    pos += f;
+                    if (std::memcmp(s + pos + 1u, n + 1u, rest) == 0) {
+                        return pos;
+                    }
+                    ++pos;
+                }
+                return search_npos;
+            }
+            /// The offset of the last place the needle appears, searching
+            /// backwards in the same way
+            template<typename C>
+            inline std::size_t rfind_units(
+                    C const *const s,
+                    std::size_t const size,
+                    C const *const n,
+                    std::size_t const m) noexcept {
+                if (m == 0u) {
+                    return size;
+                } else if (m > size) {
+                    return search_npos;
+                } else if (m == 1u) {
+                    return rfind_unit(s, size, n[0]);
+                }
+                auto const rest = (m - 1u) * sizeof(C);
+                auto starts = size - m + 1u;
+#if defined(F5_CORD_SIMD_SSE42)
+                using V = simd::native;
+                constexpr std::size_t step = V::width / sizeof(C);
+                auto const first = splat_unit(n[0]),
+                           last = splat_unit(n[m - 1u]);
+                for (; starts >= step; starts -= step) {
+                    auto const base = starts - step;
+                    auto mask = equal_units<C>(V::load(s + base), first)
+                            & equal_units<C>(V::load(s + base + m - 1u), last);
+                    while (mask) {
+                        auto const bit = simd::highest(mask);
+                        auto const at = base + bit / sizeof(C);
+                        if (std::memcmp(s + at + 1u, n + 1u, rest) == 0) {
+                            return at;
+                        }
+                        mask ^= std::uint64_t{1} << bit;
+                    }
+                }
+#endif
+                while (starts) {
+                    auto const f = rfind_unit(s, starts, n[0]);
+                    if (f == search_npos) return search_npos;
+                    if (std::memcmp(s + f + 1u, n + 1u, rest) == 0) {
+                        return f;
+                    }
+                    starts = f;
+                }
+                return search_npos;
+            }
+            /// The number of places the needle appears without overlapping
+            template<typename C>
+            inline std::size_t count_units(
+                    C const *const s,
+                    std::size_t const size,
+                    C const *const n,
+                    std::size_t const m) noexcept {
+                if (m == 0u) {
+                    return 0u;
+                } else if (m == 1u) {
+                    return count_unit(s, size, n[0]);
+                }
+                std::size_t count{};
+                for (std::size_t pos{}; pos < size; ++count) {
+                    auto const f = find_units(s + pos, size - pos, n, m);
+                    if (f == search_npos) break;
+                    pos += f + m;
+                }
+                return count;
+            }
+
+
+            /// The code units for a single code point
+            template<typename C, typename E>
+            constexpr std::pair<std::size_t, std::array<C, 4>>
+                    encode_units(utf32 const cp) {
+                if constexpr (std::is_same_v<C, utf8>) {
+                    auto const [length, units] = u8encode<E>(cp);
+                    return {std::size_t(length),
+                            {{units[0], units[1], units[2], units[3]}}};
+                } else if constexpr (std::is_same_v<C, utf16>) {
+                    auto const [length, units] = u16encode<E>(cp);
+                    return {std::size_t(length), {{units[0], units[1]}}};
+                } else {
+                    check_valid<E>(cp);
+                    return {1u, {{cp}}};
+                }
+            }
+
+            /// The number of code units in the code point starting with
+            /// `lead`. Invalid leads are taken as a single code unit.
+            template<typename C>
+            constexpr std::size_t unit_length(C const lead) noexcept {
+                if constexpr (std::is_same_v<C, utf8>) {
+                    auto const u = static_cast<unsigned char>(lead);
+                    return u < 0xc0 ? 1u : u < 0xe0 ? 2u : u < 0xf0 ? 3u : 4u;
+                } else if constexpr (std::is_same_v<C, utf16>) {
+                    return (lead & 0xfc00) == 0xd800 ? 2u : 1u;
+                } else {
+                    return 1u;
+                }
+            }
+
+
+            /**
+                Finds the first of any of a set of code points, given as
+                a string of them. Positions are found whose code unit is the
+                first of one of the code points, which for sets of up to
+                `vector_limit` distinct first code units is done a vector at
+                a time. The code points that are longer than a single code
+                unit are then compared in full.
+             */
+            template<typename C>
+            class code_point_set {
+                C const *set;
+                std::size_t set_size;
+                bool single = true;
+
+                static constexpr std::size_t vector_limit = 8u;
+                std::array<C, vector_limit> firsts = {};
+                std::size_t first_count = {};
+                /// The first code units of UTF-8 sets that don't fit in
+                /// `firsts`
+                std::array<bool, 256> table = {};
+
+                bool may_start(C const c) const noexcept {
+                    if constexpr (sizeof(C) == 1) {
+                        return table[static_cast<unsigned char>(c)];
+                    } else if (first_count <= vector_limit) {
+                        for (std::size_t f{}; f < first_count; ++f) {
+                            if (firsts[f] == c) return true;
+                        }
+                        return false;
+                    } else {
+                        for (std::size_t u{}; u < set_size; ++u) {
+                            if (set[u] == c) return true;
+                        }
+                        return false;
+                    }
+                }
+                bool matches(C const *const s, std::size_t const size)
+                        const noexcept {
+                    if (single) return true;
+                    for (std::size_t u{}; u < set_size;) {
+                        auto const length =
+                                std::min(unit_length(set[u]), set_size - u);
+                        if (set[u] == s[0] && length <= size
+                            && std::memcmp(s, set + u, length * sizeof(C))
+                                    == 0) {
+                            return true;
+                        }
+                        u += length;
+                    }
+                    return false;
+                }
+
+              public:
+                code_point_set(
+                        C const *const s, std::size_t const size) noexcept
+                : set{s}, set_size{size} {
+                    for (std::size_t u{}; u < set_size;) {
+                        auto const lead = set[u];
+                        auto const length = unit_length(lead);
+                        single = single && length == 1u;
+                        if constexpr (sizeof(C) == 1) {
+                            table[static_cast<unsigned char>(lead)] = true;
+                        }
+                        auto const known = firsts.begin()
+                                + std::min(first_count, vector_limit);
+                        if (std::find(firsts.begin(), known, lead) == known) {
+                            if (first_count < vector_limit) {
+                                firsts[first_count] = lead;
+                            }
+                            ++first_count;
+                        }
+                        u += length;
+                    }
+                }
+
+                /// The offset of the first code point in the set
+                std::size_t find(C const *const s, std::size_t const size)
+                        const noexcept {
+                    if (first_count == 0u) return search_npos;
+                    std::size_t pos{};
+#if defined(F5_CORD_SIMD_SSE42)
+                    if (first_count <= vector_limit) {
+                        using V = simd::native;
+                        constexpr std::size_t step = V::width / sizeof(C);
+                        V::vector splats[vector_limit];
+                        for (std::size_t f{}; f < first_count; ++f) {
+                            splats[f] = splat_unit(firsts[f]);
+                        }
+                        for (; size - pos >= step; pos += step) {
+                            auto const block = V::load(s + pos);
+                            std::uint64_t mask{};
+                            for (std::size_t f{}; f < first_count; ++f) {
+                                mask |= equal_units<C>(block, splats[f]);
+                            }
+                            for (; mask; mask &= mask - 1u) {
+                                auto const at =
+                                        pos + simd::lowest(mask) / sizeof(C);
+                                if (matches(s + at, size - at)) return at;
+                            }
+                        }
+                    }
+#endif
+                    for (; pos < size; ++pos) {
+                        if (may_start(s[pos]) && matches(s + pos, size - pos)) {
+                            return pos;
+                        }
+                    }
+                    return search_npos;
+                }
+            };
+
+
+        }
+
+
+    }
+
+
+}
@@ -0,0 +1,244 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/cord/unicode-string.hpp>
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <vector>
+
+
+namespace f5 {
+
+
+    namespace cord {
+
+
+        /// ## Splitting
+        /**
+            A lazy range over the parts of a view between its delimiters.
+            Each part is a view with the same control block as the text
+            being split, so it can be turned into a string without copying.
+            The delimiters are found a vector of code units at a time, the
+            same as for `find`.
+
+            The range holds the view of the text, so the string it is a view
+            of must outlive the range and the parts taken from it.
+         */
+        template<typename V>
+        class split_range {
+            using C = std::remove_const_t<typename V::value_type>;
+            using buffer_type = typename V::buffer_type;
+
+            V text, separator;
+            /// A code point delimiter is kept here in the encoding of the
+            /// text
+            std::array<C, 4> units = {};
+            std::size_t unit_count = {};
+            bool by_line = false;
+
+            C const *delimiter() const noexcept {
+                return unit_count ? units.data() : separator.data();
+            }
+            std::size_t delimiter_size() const noexcept {
+                return unit_count ? unit_count : separator.code_units();
+            }
+
+            split_range(V t, utf32 const cp, bool const l)
+            : text{t}, by_line{l} {
+                using E = typename V::encoding_error_type;
+                auto const [length, encoded] = detail::encode_units<C, E>(cp);
+                units = encoded;
+                unit_count = length;
+            }
+
+          public:
+            using view_type = V;
+
+            /// Split on each occurrence of `delimiter`. An empty delimiter
+            /// doesn't split the text at all.
+            split_range(V t, V delimiter) noexcept
+            : text{t}, separator{delimiter} {}
+            /// Split on a code point
+            split_range(V t, utf32 const cp) : split_range{t, cp, false} {}
+
+            /// Split into lines. See `lines`
+            static split_range lines(V t) { return {t, U'\n', true}; }
+
+
+            class const_iterator {
+                friend class split_range;
+                split_range const *range = nullptr;
+                V part;
+                /// Where the part after this one starts, or `npos` if this
+                /// is the last
+                std::size_t next = V::npos;
+
+                const_iterator(split_range const *r, std::size_t const from)
+                : range{r} {
+                    auto const size = range->text.code_units();
+                    auto const data = range->text.data();
+                    auto const dsize = range->delimiter_size();
+                    auto const found = dsize
+                            ? detail::find_units(
+                                    data + from, size - from,
+                                    range->delimiter(), dsize)
+                            : V::npos;
+                    auto length = size - from;
+                    if (found != V::npos) {
+                        length = found;
+                        next = from + found + dsize;
+                    }
+                    if (range->by_line) {
+                        if (found != V::npos && length
+                            && data[from + length - 1u] == C{'\r'}) {
+                            --length;
+                        }
+                        if (next == size) next = V::npos;
+                    }
+                    part = V{buffer_type{data + from, length},
+                             range->text.control_block()};
+                }
+
+              public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = V;
+                using difference_type = std::ptrdiff_t;
+                using pointer = V const *;
+                using reference = V const &;
+
+                /// The end iterator
+                const_iterator() noexcept {}
+
+                reference operator*() const noexcept { return part; }
+                pointer operator->() const noexcept { return &part; }
+
+                const_iterator &operator++() {
+                    if (next == V::npos) {
+                        *this = const_iterator{};
+                    } else {
+                        *this = const_iterator{range, next};
+                    }
+                    return *this;
+                }
+                const_iterator operator++(int) {
+                    auto const was = *this;
+                    ++*this;
+                    return was;
+                }
+
+                bool operator==(const_iterator const &i) const noexcept {
+                    return range == i.range && part.data() == i.part.data()
+                            && next == i.next;
+                }
+                bool operator!=(const_iterator const &i) const noexcept {
+                    return not(*this == i);
+                }
+            };
+            using iterator = const_iterator;
+
+            const_iterator begin() const {
+                if (by_line && text.empty()) {
+                    return {};
+                } else {
+                    return {this, 0u};
+                }
+            }
+            const_iterator end() const noexcept { return {}; }
+
+            /// The number of parts. The delimiters are counted, which is
+            /// much quicker than iterating.
+            std::size_t count() const noexcept {
+                auto const size = text.code_units();
+                auto const dsize = delimiter_size();
+                if (by_line) {
+                    if (size == 0u) return 0u;
+                    return detail::count_unit(text.data(), size, C{'\n'})
+                            + (text.data()[size - 1u] != C{'\n'});
+                } else if (dsize == 0u) {
+                    return 1u;
+                } else {
+                    return detail::count_units(
+                                   text.data(), size, delimiter(), dsize)
+                            + 1u;
+                }
+            }
+        };
+
+
+        /// Split a view or string on a delimiter, which can be a view of
+        /// any number of code units or a single code point. There is always
+        /// one more part than there are delimiters, so an empty text has a
+        /// single empty part.
+        template<typename C, typename E, typename IM, typename R>
+        inline split_range<basic_view<C, E, IM, R>> split(
+                basic_view<C, E, IM, R> const text,
+                typename split_range<basic_view<C, E, IM, R>>::view_type const
+                        delimiter) noexcept {
+            return {text, delimiter};
+        }
+        template<typename C, typename E, typename IM, typename R>
+        inline split_range<basic_view<C, E, IM, R>>
+                split(basic_view<C, E, IM, R> const text, utf32 const cp) {
+            return {text, cp};
+        }
+        template<typename C, typename V>
+        inline split_range<V> split(
+                basic_string<C, V> const &s,
+                typename split_range<V>::view_type const delimiter) noexcept {
+            return {V{s}, delimiter};
+        }
+        template<typename C, typename V>
+        inline split_range<V>
+                split(basic_string<C, V> const &s, utf32 const cp) {
+            return {V{s}, cp};
+        }
+
+        /// Split a view or string into lines. A `\r` before a `\n` isn't
+        /// part of the line, but one at the very end of the text is. There
+        /// is no empty last line after a final `\n`, so an empty text has
+        /// no lines at all.
+        template<typename C, typename E, typename IM, typename R>
+        inline split_range<basic_view<C, E, IM, R>>
+                lines(basic_view<C, E, IM, R> const text) {
+            return split_range<basic_view<C, E, IM, R>>::lines(text);
+        }
+        template<typename C, typename V>
+        inline split_range<V> lines(basic_string<C, V> const &s) {
+            return split_range<V>::lines(V{s});
+        }
+
+
+        /**
+            Append a string to `out` for each part of the split text and
+            return how many there were. The delimiters are counted first so
+            that `out` only grows once, and the strings for the parts count
+            their shared control block with a single change.
+         */
+        template<typename C, typename V>
+        inline std::size_t split_to(
+                split_range<V> const &parts,
+                std::vector<basic_string<C, V>> &out) {
+            auto const before = out.size();
+            auto const needed = before + parts.count();
+            if (needed > out.capacity()) {
+                out.reserve(std::max(needed, 2u * out.capacity()));
+            }
+            basic_string<C, V>::append_shared(out, parts.begin(), parts.end());
+            return out.size() - before;
+        }
+
+
+    }
+
+
+}
@@ -0,0 +1,155 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/cord/unicode-validate.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace f5 {
+
+
+    namespace cord {
+
+
+        /// ## `u8stream_validator`
+        /**
+            Validates UTF-8 that arrives in chunks that can split code
+            points anywhere, such as reads from a socket or pipe. Each call
+            to `feed` checks a chunk using the same bulk validation as
+            `valid_length` and returns views of the valid code points in it.
+
+            Up to three bytes of a code point left incomplete at the end of
+            a chunk are held on to. Once the rest of it arrives the whole
+            code point is returned as `joined`, which is a view of storage
+            inside the validator and is only good until the next call to
+            `feed`. `valid` is a view over the chunk itself.
+
+            Once an invalid sequence is found the validator stops: `error`
+            is set, `valid` ends just before the bad code unit, and later
+            chunks are ignored until `reset` is called.
+         */
+        class u8stream_validator {
+            unsigned char pending[4] = {}, completed[4] = {};
+            std::size_t pending_size = {}, needed = {};
+            bool failed = false;
+
+            /// Check the bytes held so far could still be the start of a
+            /// valid code point
+            bool pending_ok() const noexcept {
+                auto const [length, low, high] = detail::u8lead(pending[0]);
+                if (pending_size >= 2u
+                    && (pending[1] < low || pending[1] > high)) {
+                    return false;
+                }
+                for (std::size_t c{2u}; c < pending_size && c < length; ++c) {
+                    if ((pending[c] & 0xc0) != 0x80) return false;
+                }
+                return true;
+            }
+            /// Hold on to an incomplete code point from the end of a chunk
+            bool hold(
+                    unsigned char const *const s,
+                    std::size_t const size) noexcept {
+                needed = detail::u8lead(s[0]).length;
+                if (size >= needed) return false;
+                std::memcpy(pending, s, size);
+                pending_size = size;
+                return pending_ok();
+            }
+
+          public:
+            struct result {
+                /// A code point that started in an earlier chunk and was
+                /// completed by this one
+                u8view joined;
+                /// The complete and valid code points in the chunk
+                u8view valid;
+                /// An invalid sequence was found
+                bool error = false;
+            };
+
+
+            /// Validate the next chunk of input
+            result feed(const_u8buffer const chunk) noexcept {
+                result r;
+                if (failed) {
+                    r.error = true;
+                    return r;
+                }
+                auto s = reinterpret_cast<unsigned char const *>(chunk.data());
+                auto size = chunk.size();
+
+                /// First finish off any code point carried over
+                if (pending_size) {
+                    auto const take = std::min(needed - pending_size, size);
+                    std::memcpy(pending + pending_size, s, take);
+                    pending_size += take;
+                    s += take;
+                    size -= take;
+                    if (pending_size < needed) {
+                        failed = not pending_ok();
+                        r.error = failed;
+                        return r;
+                    } else if (
+                            detail::u8valid_length(pending, needed) != needed) {
+                        failed = r.error = true;
+                        return r;
+                    }
+                    /// Moved out of the way as the end of this chunk
+                    /// may need to be held on to
+                    std::memcpy(completed, pending, needed);
+                    r.joined = u8view{
+                            reinterpret_cast<char const *>(completed), needed};
+                    pending_size = 0u;
+                }
+
+                auto const length = valid_length(const_u8buffer{
+                        reinterpret_cast<utf8 const *>(s), size});
+                r.valid = u8view{reinterpret_cast<char const *>(s), length};
+                if (length < size) {
+                    /// The remainder is either an incomplete code point at
+                    /// the very end of the chunk or an error
+                    if (size - length >= 4u
+                        || not hold(s + length, size - length)) {
+                        pending_size = 0u;
+                        failed = r.error = true;
+                    }
+                }
+                return r;
+            }
+
+            /// The number of bytes being held for an incomplete code point
+            std::size_t carried() const noexcept { return pending_size; }
+            /// `true` if an invalid sequence has been found
+            bool error() const noexcept { return failed; }
+
+            /// Call at the end of the input. Returns `true` if everything
+            /// fed was valid and the last code point was complete.
+            bool finish() const noexcept {
+                return not failed && pending_size == 0u;
+            }
+            /// Start again with a new stream
+            void reset() noexcept {
+                pending_size = needed = 0u;
+                failed = false;
+            }
+        };
+
+
+    }
+
+
+    using u8stream_validator = cord::u8stream_validator;
+
+
+}
@@ -9,8 +9,16 @@
 #pragma once
 
 
+#include <f5/cord/unicode-transcode.hpp>
+#include <f5/cord/unicode-validate.hpp>
 #include <f5/cord/unicode-view.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <utility>
+#include <vector>
+
 
 namespace f5 {
 
@@ -18,13 +26,96 @@ namespace f5 {
     namespace cord {
 
 
+        /// ## Compaction
+        /**
+            A long string made from part of a view shares the view's
+            allocation, which stays alive for as long as the string does.
+            When a `policy` is set it is asked, for each of these, whether
+            the string should copy its code units instead. It is given the
+            bytes the string uses and the bytes in the allocation, which is
+            only known for allocations that record their size. The policy
+            can be changed at any time.
+
+                f5::cord::compaction::policy =
+                        f5::cord::compaction::below<10, 1u << 20>;
+         */
+        struct compaction {
+            using policy_function = bool (*)(
+                    std::size_t used, std::size_t allocated) noexcept;
+            static inline std::atomic<policy_function> policy{nullptr};
+
+            /// Copy strings using less than `Percent`% of an allocation of
+            /// at least `Bytes` bytes
+            template<std::size_t Percent, std::size_t Bytes>
+            static bool below(
+                    std::size_t const used,
+                    std::size_t const allocated) noexcept {
+                return allocated >= Bytes && used * 100u < allocated * Percent;
+            }
+        };
+
+
         /// UTF8 string with shared ownership.
         template<typename C, typename V = basic_view<C>>
         class basic_string {
             using view_type = V;
             typename view_type::buffer_type buffer;
             using control_type = typename view_type::control_type;
-            control_type *owner;
+
+            /// Short strings are stored inside the object, in the space
+            /// taken up by the control block pointer and the same again.
+            /// The string is inline when the `buffer` points at `local`.
+#if defined(F5_CORD_NO_SSO)
+            static constexpr std::size_t local_size = 0u;
+#else
+            static constexpr std::size_t local_size =
+                    2u * sizeof(control_type *) / sizeof(C);
+#endif
+            union {
+                control_type *owner;
+                C local[local_size ? local_size : 1u];
+            };
+
+            /// Copy the code units into the object. There is always space
+            /// for a NUL terminator after them.
+            void make_inline(
+                    typename view_type::value_type const *const data,
+                    std::size_t const size) noexcept {
+                std::char_traits<C>::move(local, data, size);
+                local[size] = C{};
+                buffer = typename view_type::buffer_type{local, size};
+            }
+            /// Copying an inline string copies the whole of `local` as that
+            /// is cheaper than working out how much of it is used
+            void copy_inline(basic_string const &s) noexcept {
+                std::memcpy(local, s.local, sizeof(local));
+                buffer = typename view_type::buffer_type{local, s.buffer.size()};
+            }
+            static constexpr bool fits_inline(std::size_t const size) noexcept {
+                return local_size && size < local_size;
+            }
+
+            /// Make space in an empty string for up to `capacity` code units.
+            /// Long strings get a control block with the code units after
+            /// it in the same allocation, with room for a NUL terminator.
+            C *allocate(std::size_t const capacity) {
+                if (fits_inline(capacity)) {
+                    buffer = buffer_type{local, std::size_t{}};
+                    return local;
+                } else {
+                    auto created = control_type::template make_array<C>(
+                            capacity + 1u, capacity);
+                    owner = created.first.release();
+                    buffer = buffer_type{created.second, std::size_t{}};
+                    return created.second;
+                }
+            }
+            /// Record how much of the allocated space has been used
+            void allocated(C *const out, std::size_t const size) noexcept {
+                out[size] = C{};
+                if (not is_inline()) { owner->user_data = size; }
+                buffer = buffer_type{out, size};
+            }
 
             /**
              * Temporary re-allocation function used to handle the cases
@@ -35,7 +126,54 @@ namespace f5 {
              * `basic_string`.
              */
             void transitional_allocation() {
-                if (owner == nullptr) { shrink_to_fit(); }
+                if (fits_inline(buffer.size())) {
+                    make_inline(buffer.data(), buffer.size());
+                } else if (owner == nullptr) {
+                    stats::record(stats::counter::transitional_copies);
+                    *this = basic_string{data(), code_units()};
+                }
+            }
+
+            /// The number of code units in the allocation, or `npos` when
+            /// it isn't known
+            std::size_t allocation_size() const noexcept {
+                return owner ? std::size_t(owner->user_data) : npos;
+            }
+            /// Whether the string uses less than the whole of its
+            /// allocation
+            bool is_partial() const noexcept {
+                if (is_inline()) return false;
+                auto const allocated = allocation_size();
+                return allocated != npos && code_units() < allocated;
+            }
+
+            /// Copy a string made from part of a larger allocation when the
+            /// compaction policy says to
+            void apply_compaction() {
+                auto const policy =
+                        compaction::policy.load(std::memory_order_relaxed);
+                if (policy && is_partial()
+                    && policy(memory().size(),
+                              allocation_size() * sizeof(C))) {
+                    stats::record(stats::counter::compactions);
+                    *this = basic_string{data(), code_units()};
+                }
+            }
+
+            /// Raise an error if the encoding is not valid
+            static view_type check_encoding(view_type const v) {
+                if (valid_length(static_cast<buffer_type>(v)) != v.code_units()) {
+                    using E = typename view_type::encoding_error_type;
+                    raise_encoding<E>(
+                            "Invalid code unit sequence found when "
+                            "constructing string");
+                }
+                return v;
+            }
+            template<typename S>
+            static S check_encoding(S s) {
+                check_encoding(view_type{s.data(), s.size()});
+                return s;
             }
 
           public:
@@ -51,6 +189,9 @@ namespace f5 {
 
             using size_type = typename view_type::size_type;
             constexpr static size_type const npos = view_type::npos;
+            /// The longest string (in code units) that is stored inline
+            constexpr static size_type const inline_capacity =
+                    local_size ? local_size - 1u : 0u;
 
 
             /// ## Constructors
@@ -59,19 +200,33 @@ namespace f5 {
 
             /// The type is copyable and movable. Handle the control block
             /// appropriately.
-            basic_string(basic_string const &b)
-            : buffer{b.buffer}, owner{control_type::increment(b.owner)} {}
-            basic_string(basic_string &&b)
-            : buffer{b.buffer}, owner{std::exchange(b.owner, nullptr)} {}
+            basic_string(basic_string const &b) : buffer{b.buffer}, owner{} {
+                if (b.is_inline()) {
+                    copy_inline(b);
+                } else {
+                    owner = control_type::increment(b.owner);
+                }
+            }
+            basic_string(basic_string &&b) noexcept
+            : buffer{b.buffer}, owner{} {
+                if (b.is_inline()) {
+                    copy_inline(b);
+                } else {
+                    owner = std::exchange(b.owner, nullptr);
+                }
+            }
 
             /// Creation from a `basic_view` will never allocate because the
             /// `basic_view` remembers the shared status of its history.
             /// During the transitional period however basic_view *may*
-            /// allocate.
-            basic_string(view_type const v)
-            : buffer{buffer_type{v}},
-              owner{control_type::increment(v.control_block())} {
+            /// allocate. Short strings are always copied inline rather
+            /// than sharing the view's control block.
+            basic_string(view_type const v) : buffer{buffer_type{v}}, owner{} {
+                if (not fits_inline(buffer.size())) {
+                    owner = control_type::increment(v.control_block());
+                }
                 transitional_allocation();
+                apply_compaction();
             }
 
             /// From literals we have a `nullptr` control block as we have
@@ -84,37 +239,222 @@ namespace f5 {
 
             /// For `std_string` we have to move the string into a memory area
             /// we can control
-            explicit basic_string(std_string s) : buffer{}, owner{} {
-                auto created = control_type::make(std::move(s), s.size());
-                owner = created.first.release();
-                buffer = buffer_type{
-                        created.second->data(), created.second->size()};
-            }
-            /// Given a data block we are going to have to allocate as well
+            explicit basic_string(std_string const &s)
+            : basic_string{s.data(), s.size()} {}
+            /// Given a data block we are going to have to allocate as well,
+            /// unless it is short enough to store inline
             basic_string(value_type const *data, std::size_t size)
-            : basic_string(std_string{data, size}) {}
+            : buffer{}, owner{} {
+                auto const out = allocate(size);
+                std::char_traits<C>::copy(out, data, size);
+                allocated(out, size);
+            }
 
-            /// Construct from character literals in the non-native encodings
+            /// Opt-in construction that checks the encoding is valid before
+            /// the string is made. An `encoding_error_type` is raised if it
+            /// is not.
+            basic_string(checked_t, view_type const v)
+            : basic_string{check_encoding(v)} {}
+            template<
+                    typename S,
+                    typename = std::enable_if_t<std::is_same_v<S, std_string>>>
+            basic_string(checked_t, S s)
+            : basic_string{check_encoding(std::move(s))} {}
+            basic_string(checked_t, value_type const *data, std::size_t size)
+            : basic_string{check_encoding(std_string{data, size})} {}
+
+            /// Construct from character literals in the non-native encodings.
+            /// This transcodes at run time, the `_u8` literal does it at
+            /// compile time instead.
             template<typename O, std::size_t N>
             explicit basic_string(O const (&s)[N])
-            : basic_string{[&]() {
-                  using o_view =
-                          basic_view<O, typename view_type::encoding_error_type>;
-                  o_view nn{s};
-                  std_string ret;
-                  ret.reserve(N);
-                  for (auto u32 : nn) {
-                      auto const en = iterator_map::encode_one(u32);
-                      ret.append(en.second.data(), en.first);
-                  }
-                  return ret;
-              }()} {}
-
-            ~basic_string() { control_type::decrement(owner); }
+            : basic_string{basic_view<O, typename view_type::encoding_error_type>{
+                      s}} {}
+            /// Construct by transcoding from one of the other encodings.
+            /// The output is allocated once at exactly the right size.
+            template<
+                    typename O,
+                    typename OE,
+                    typename OIM,
+                    typename = std::enable_if_t<not std::is_same_v<O, C>>>
+            explicit basic_string(basic_view<O, OE, OIM> const v)
+            : basic_string{build([v](auto allocate) {
+                  return detail::transcoded<
+                          C, typename view_type::encoding_error_type>(
+                          basic_view<O>{static_cast<f5::buffer<O const>>(v)},
+                          allocate);
+              })} {}
+
+            /// Strings that use the other reference counting policy. They
+            /// can't share a control block with this string so long
+            /// strings are copied. The conversion is explicit so that the
+            /// copy is always visible.
+            template<
+                    typename OV,
+                    typename = std::enable_if_t<
+                            not std::is_same_v<OV, V>
+                            && std::is_same_v<
+                                    typename OV::value_type,
+                                    value_type>>>
+            explicit basic_string(basic_string<C, OV> const &s)
+            : basic_string{s.data(), s.code_units()} {}
+
+            /// Build a new string by writing directly into its storage.
+            /// `fill` is passed a function that returns space for the number
+            /// of code units asked for. This will be inline if they fit and
+            /// otherwise a single new allocation. `fill` returns how many
+            /// code units it wrote.
+            template<typename F>
+            static basic_string build(F &&fill) {
+                basic_string s;
+                C *out = nullptr;
+                auto const size =
+                        fill([&s, &out](std::size_t const capacity) {
+                            return out = s.allocate(capacity);
+                        });
+                if (out) { s.allocated(out, size); }
+                return s;
+            }
+
+            /// A copy of the view in an allocation of its own, even if it
+            /// is short enough to be inline. Copies of the result share the
+            /// allocation, so its ownership count says how many of them
+            /// there are.
+            static basic_string shared_copy(view_type const v) {
+                auto const size = v.code_units();
+                auto created = control_type::template make_array<C>(
+                        size + 1u, size);
+                std::char_traits<C>::copy(created.second, v.data(), size);
+                created.second[size] = C{};
+                basic_string s;
+                s.owner = created.first.release();
+                s.buffer = buffer_type{created.second, size};
+                return s;
+            }
+
+            /**
+                Append a string to `out` for each of the views from `first`
+                to `last`. Neighbouring views that share a control block
+                have it counted once for all of them, instead of once for
+                each string. `out` needs `size`, `capacity`, `reserve` and
+                `push_back`.
+             */
+            template<typename Container, typename I>
+            static void append_shared(Container &out, I first, I const last) {
+                /// New owners of `block` not yet counted. They are counted
+                /// before anything that could release one of them.
+                struct pending_owners {
+                    control_type *block = nullptr;
+                    std::size_t count = {};
+                    void flush() noexcept {
+                        control_type::increment(block, count);
+                        count = 0u;
+                    }
+                    ~pending_owners() { flush(); }
+                } pending;
+                for (; first != last; ++first) {
+                    view_type const v = *first;
+                    if (out.size() == out.capacity()) {
+                        pending.flush();
+                        out.reserve(std::max(
+                                std::size_t{16u}, 2u * out.capacity()));
+                    }
+                    if (v.control_block() != pending.block) {
+                        pending.flush();
+                        pending.block = v.control_block();
+                    }
+                    /// There is room, so this can't throw
+                    out.push_back(basic_string{adopt_t{}, v});
+                    if (pending.block && not fits_inline(v.code_units())) {
+                        ++pending.count;
+                    }
+                }
+            }
+
+            /**
+                Move the strings in `strings` that use only part of their
+                allocation into a single new allocation holding just their
+                code units, each followed by a NUL, and return how many were
+                moved. The strings of an allocation are left where they are
+                if together they fill it, so a second pass over the same
+                strings moves nothing, and so are those in allocations that
+                don't record their size.
+             */
+            template<typename R>
+            static std::size_t rehome(R &strings) {
+                std::vector<basic_string *> partial;
+                for (basic_string &s : strings) {
+                    if (s.is_partial()) partial.push_back(&s);
+                }
+                std::stable_sort(
+                        partial.begin(), partial.end(),
+                        [](auto const *l, auto const *r) {
+                            return std::less<>{}(l->owner, r->owner);
+                        });
+                std::size_t units{};
+                auto keep = partial.begin();
+                for (auto group = partial.begin(); group != partial.end();) {
+                    auto const block = (*group)->owner;
+                    std::size_t used{};
+                    auto next = group;
+                    for (; next != partial.end() && (*next)->owner == block;
+                         ++next) {
+                        used += (*next)->code_units() + 1u;
+                    }
+                    if (used <= (*group)->allocation_size()) {
+                        units += used;
+                        keep = std::copy(group, next, keep);
+                    }
+                    group = next;
+                }
+                partial.erase(keep, partial.end());
+                if (partial.empty()) return 0u;
+
+                /// A single string gets an allocation just like any other
+                /// string's, so `shrink_to_fit` knows it is NUL terminated
+                auto created = control_type::template make_array<C>(
+                        units, units - 1u);
+                auto const block = created.first.release();
+                auto out = created.second;
+                control_type::increment(block, partial.size() - 1u);
+                for (auto const s : partial) {
+                    auto const size = s->code_units();
+                    std::char_traits<C>::copy(out, s->data(), size);
+                    out[size] = C{};
+                    control_type::decrement(s->owner);
+                    s->owner = block;
+                    s->buffer = buffer_type{out, size};
+                    out += size + 1u;
+                    stats::record(stats::counter::compactions);
+                }
+                return partial.size();
+            }
+
+            ~basic_string() { control_type::decrement(control_block()); }
+
+          private:
+            /// Share the view's control block without counting the new
+            /// owner. `append_shared` counts them together.
+            struct adopt_t {};
+            basic_string(adopt_t, view_type const v)
+            : buffer{buffer_type{v}}, owner{} {
+                if (not fits_inline(buffer.size())) {
+                    owner = v.control_block();
+                }
+                transitional_allocation();
+            }
+
+          public:
 
 
             /// ## Conversions
-            operator view_type() const { return view_type{buffer, owner}; }
+
+            /// The view of an inline string has no control block. Like a
+            /// view of a `std::string` it must be copied into a new string
+            /// to keep the data after this string is gone.
+            operator view_type() const {
+                return view_type{buffer, control_block()};
+            }
             operator std_string_view() const noexcept {
                 return static_cast<std_string_view>(
                         static_cast<view_type>(*this));
@@ -136,23 +476,45 @@ namespace f5 {
             /// allocation so that we can check if we need to re-allocate s
             /// new string or not.
             value_type const *shrink_to_fit() {
-                if ((owner && owner->user_data != code_units()) || not owner) {
-                    *this = basic_string{static_cast<std_string>(*this)};
+                if (is_inline()) {
+                    return data();
+                } else if (
+                        (owner && owner->user_data != code_units()) || not owner) {
+                    stats::record(stats::counter::shrink_to_fit_copies);
+                    *this = basic_string{data(), code_units()};
                 }
                 return data();
             }
 
             /// ## Assignment
+            /// Self assignment is checked for as copying inline storage onto
+            /// itself isn't allowed
             basic_string &operator=(const basic_string &s) noexcept {
-                control_type::decrement(owner);
-                buffer = s.buffer;
-                owner = control_type::increment(s.owner);
+                if (this == &s) {
+                    return *this;
+                } else if (s.is_inline()) {
+                    control_type::decrement(control_block());
+                    copy_inline(s);
+                } else {
+                    auto const o = control_type::increment(s.owner);
+                    control_type::decrement(control_block());
+                    buffer = s.buffer;
+                    owner = o;
+                }
                 return *this;
             }
             basic_string &operator=(basic_string &&s) noexcept {
-                control_type::decrement(owner);
-                buffer = s.buffer;
-                owner = std::exchange(s.owner, nullptr);
+                if (this == &s) {
+                    return *this;
+                } else if (s.is_inline()) {
+                    control_type::decrement(control_block());
+                    copy_inline(s);
+                } else {
+                    auto const o = std::exchange(s.owner, nullptr);
+                    control_type::decrement(control_block());
+                    buffer = s.buffer;
+                    owner = o;
+                }
                 return *this;
             }
 
@@ -166,14 +528,26 @@ namespace f5 {
             const_iterator end() const noexcept {
                 return static_cast<view_type>(*this).end();
             }
+            using const_reverse_iterator =
+                    typename view_type::const_reverse_iterator;
+            const_reverse_iterator rbegin() const noexcept {
+                return static_cast<view_type>(*this).rbegin();
+            }
+            const_reverse_iterator rend() const noexcept {
+                return static_cast<view_type>(*this).rend();
+            }
 
             /// Construct from a pair of iterators
             basic_string(const_iterator b, const_iterator e) noexcept
             : buffer{iterator_map::template get_buffer<buffer_type, control_type>(
                     b, e)},
-              owner{control_type::increment(b.owner)} {
+              owner{} {
                 assert(b.owner == e.owner);
+                if (not fits_inline(buffer.size())) {
+                    owner = control_type::increment(b.owner);
+                }
                 transitional_allocation();
+                apply_compaction();
             }
 
             /// An iterator that produces UTF16 code units from the string
@@ -192,14 +566,23 @@ namespace f5 {
             /// ## Queries
 
             /// Returns `true` if this is a shared string
-            bool is_shared() const noexcept { return owner != nullptr; }
+            bool is_shared() const noexcept {
+                return control_block() != nullptr;
+            }
+            /// Returns `true` if the string is short enough to be stored
+            /// inside the object itself
+            bool is_inline() const noexcept {
+                return local_size && buffer.data() == local;
+            }
             /// Returns true if the other string uses the same allocation
             /// as this (they have the same control block).
-            bool shares_allocation_with(view_type const v) noexcept {
-                return owner != nullptr && owner == v.control_block();
+            bool shares_allocation_with(view_type const v) const noexcept {
+                return is_shared() && control_block() == v.control_block();
             }
             /// Return the memory control block
-            control_type *control_block() const noexcept { return owner; }
+            control_type *control_block() const noexcept {
+                return is_inline() ? nullptr : owner;
+            }
 
             /// Return the data array
             value_type *data() const noexcept { return buffer.data(); }
@@ -210,7 +593,9 @@ namespace f5 {
             /// Return the number of code units
             std::size_t code_units() const noexcept { return buffer.size(); }
             /// Return the size in code points
-            auto code_points() const { return std::distance(begin(), end()); }
+            std::size_t code_points() const noexcept {
+                return count_code_points(buffer);
+            }
             /// Return true if the string is empty
             bool empty() const noexcept { return buffer.empty(); }
             /// Return the underlying memory block for the data
@@ -225,21 +610,63 @@ namespace f5 {
             }
 
 
+            /// ## Searching
+
+            /// See the searching in `basic_view`. The iterators returned
+            /// keep the string's control block.
+            const_iterator find(view_type str) const {
+                return view_type{*this}.find(str);
+            }
+            const_iterator find(utf32 const cp) const {
+                return view_type{*this}.find(cp);
+            }
+            std::size_t find_offset(view_type str) const noexcept {
+                return view_type{*this}.find_offset(str);
+            }
+            std::size_t find_offset(utf32 const cp) const {
+                return view_type{*this}.find_offset(cp);
+            }
+            const_iterator rfind(view_type str) const {
+                return view_type{*this}.rfind(str);
+            }
+            const_iterator rfind(utf32 const cp) const {
+                return view_type{*this}.rfind(cp);
+            }
+            std::size_t rfind_offset(view_type str) const noexcept {
+                return view_type{*this}.rfind_offset(str);
+            }
+            std::size_t rfind_offset(utf32 const cp) const {
+                return view_type{*this}.rfind_offset(cp);
+            }
+            const_iterator find_first_of(view_type set) const {
+                return view_type{*this}.find_first_of(set);
+            }
+            std::size_t find_first_of_offset(view_type set) const noexcept {
+                return view_type{*this}.find_first_of_offset(set);
+            }
+            bool contains(view_type str) const noexcept {
+                return view_type{*this}.contains(str);
+            }
+            bool contains(utf32 const cp) const {
+                return view_type{*this}.contains(cp);
+            }
+            std::size_t count(view_type str) const noexcept {
+                return view_type{*this}.count(str);
+            }
+            std::size_t count(utf32 const cp) const {
+                return view_type{*this}.count(cp);
+            }
+
+
             /// ## Substrings
 
             /// Safe substring against Unicode code point counts. The result
             /// is undefined if the end marker is smaller than the start marker.
             basic_string substr(std::size_t s) const {
-                auto pos = begin();
-                auto const e = end();
-                for (; s && pos != e; --s, ++pos)
-                    ;
-                return basic_string(pos, e);
+                return basic_string{view_type{*this}.substr(s)};
             }
             basic_string substr_pos(std::size_t s, std::size_t e) const {
-                auto starts = substr(s);
-                auto ends = starts.substr(e - s);
-                return basic_string(starts.begin(), ends.begin());
+                return basic_string{view_type{*this}.substr_pos(s, e)};
             }
 
 
@@ -293,16 +720,48 @@ namespace f5 {
         using u8string = basic_string<char>;
         using u16string = basic_string<char16_t>;
         using u32string = basic_string<char32_t>;
+        /// A UTF-8 string whose reference count is not atomic. Copying and
+        /// destroying these is cheaper, but a string and all of its copies
+        /// and views must stay on the thread that made it. Convert to a
+        /// `u8string` to pass the content to another thread.
+        using u8string_local = basic_string<char, u8view_local>;
+
+
+        /// ## Transcoding
+
+        /// Transcode a string to a new string in another encoding
+        template<typename To, typename E = std::range_error>
+        inline basic_string<To> transcode(u8view const v) {
+            return basic_string<To>::build([v](auto allocate) {
+                return detail::transcoded<To, E>(v, allocate);
+            });
+        }
+        template<typename To, typename E = std::range_error>
+        inline basic_string<To> transcode(u16view const v) {
+            return basic_string<To>::build([v](auto allocate) {
+                return detail::transcoded<To, E>(v, allocate);
+            });
+        }
+        template<typename To, typename E = std::range_error>
+        inline basic_string<To> transcode(u32view const v) {
+            return basic_string<To>::build([v](auto allocate) {
+                return detail::transcoded<To, E>(v, allocate);
+            });
+        }
 
 
         /// ## Concatenation
         template<typename C>
         inline basic_string<C> operator+(basic_view<C> f, basic_view<C> e) {
-            std::basic_string<C> r;
-            r.reserve(f.code_units() + e.code_units());
-            r.append(f.data(), f.code_units());
-            r.append(e.data(), e.code_units());
-            return basic_string<C>{r};
+            stats::record(stats::counter::concatenations);
+            return basic_string<C>::build([f, e](auto allocate) {
+                auto const size = f.code_units() + e.code_units();
+                auto const out = allocate(size);
+                std::char_traits<C>::copy(out, f.data(), f.code_units());
+                std::char_traits<C>::copy(
+                        out + f.code_units(), e.data(), e.code_units());
+                return size;
+            });
         }
         template<typename C>
         inline auto operator+(basic_string<C> l, basic_view<C> r) {
@@ -350,6 +809,7 @@ namespace f5 {
     using u8string = cord::u8string;
     using u16string = cord::u16string;
     using u32string = cord::u32string;
+    using u8string_local = cord::u8string_local;
 
 
 }
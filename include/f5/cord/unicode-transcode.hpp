@@ -0,0 +1,736 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/cord/unicode-count.hpp>
+#include <f5/cord/unicode-validate.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string>
+#include <utility>
+
+
+namespace f5 {
+
+
+    namespace cord {
+
+
+        namespace detail {
+
+
+            /// Decode a single code point from UTF-8 that is already known
+            /// to be valid, moving `pos` past it
+            inline utf32 u8decode_valid(
+                    unsigned char const *const s, std::size_t &pos) noexcept {
+                auto const lead = s[pos];
+                if (lead < 0x80) {
+                    pos += 1u;
+                    return lead;
+                } else if (lead < 0xe0) {
+                    auto const cp = (utf32(lead & 0x1f) << 6)
+                            | utf32(s[pos + 1] & 0x3f);
+                    pos += 2u;
+                    return cp;
+                } else if (lead < 0xf0) {
+                    auto const cp = (utf32(lead & 0x0f) << 12)
+                            | (utf32(s[pos + 1] & 0x3f) << 6)
+                            | utf32(s[pos + 2] & 0x3f);
+                    pos += 3u;
+                    return cp;
+                } else {
+                    auto const cp = (utf32(lead & 0x07) << 18)
+                            | (utf32(s[pos + 1] & 0x3f) << 12)
+                            | (utf32(s[pos + 2] & 0x3f) << 6)
+                            | utf32(s[pos + 3] & 0x3f);
+                    pos += 4u;
+                    return cp;
+                }
+            }
+
+
+            /// Write the UTF-16 for a valid code point, returning the number
+            /// of code units used
+            inline std::size_t u16write(utf32 const cp, utf16 *const out) noexcept {
+                if (cp < 0x1'0000) {
+                    out[0] = static_cast<utf16>(cp);
+                    return 1u;
+                } else {
+                    out[0] = static_cast<utf16>(0xd800 - (0x10000 >> 10) + (cp >> 10));
+                    out[1] = static_cast<utf16>(0xdc00 + (cp & 0x3ff));
+                    return 2u;
+                }
+            }
+
+
+            /// The number of UTF-16 code units needed for valid UTF-8. This
+            /// is the number of code points plus one more for each four byte
+            /// sequence.
+            inline std::size_t u8u16length(
+                    char const *const s, std::size_t const size) noexcept {
+                std::size_t units{}, pos{};
+#if defined(F5_CORD_SIMD_SSE42)
+                using V = simd::native;
+                auto const continuation = V::splat(0xbf), four = V::splat(0xef);
+                for (; size - pos >= V::width; pos += V::width) {
+                    auto const v = V::load(s + pos);
+                    units += simd::popcount(V::greater(v, continuation))
+                            + simd::popcount(
+                                    V::high_bits(v) & V::greater(v, four));
+                }
+#endif
+                for (; pos < size; ++pos) {
+                    auto const b = static_cast<unsigned char>(s[pos]);
+                    if ((b & 0xc0) != 0x80) ++units;
+                    if (b >= 0xf0) ++units;
+                }
+                return units;
+            }
+
+
+            /// Transcode valid UTF-8 to UTF-16. The output must have space
+            /// for the result. Leading ASCII in a block is widened a vector
+            /// at a time when there is room in the output for the whole
+            /// vector, then the following non-ASCII is decoded one code point
+            /// at a time.
+            inline std::size_t u8u16(
+                    unsigned char const *const s,
+                    std::size_t const size,
+                    utf16 *const out,
+                    [[maybe_unused]] std::size_t const capacity) noexcept {
+#if defined(F5_CORD_SIMD_SSE42)
+                using V = simd::native;
+                constexpr std::size_t block = V::width;
+#else
+                constexpr std::size_t block = 8u;
+#endif
+                std::size_t pos{}, written{};
+                while (pos < size) {
+                    if (size - pos >= block) {
+#if defined(F5_CORD_SIMD_SSE42)
+                        auto const v = V::load(s + pos);
+                        auto const high = V::high_bits(v);
+                        if (not high || capacity - written >= block) {
+                            auto const ascii = high ? simd::lowest(high) : block;
+                            V::store16(out + written, v);
+                            pos += ascii;
+                            written += ascii;
+                            if (not high) continue;
+                        }
+#else
+                        if (simd::is_ascii(simd::load64(s + pos))) {
+                            for (std::size_t c{}; c < block; ++c) {
+                                out[written + c] = s[pos + c];
+                            }
+                            pos += block;
+                            written += block;
+                            continue;
+                        }
+#endif
+                    }
+                    auto const until = std::min(size, pos + block);
+                    do {
+                        written += u16write(u8decode_valid(s, pos), out + written);
+                    } while (pos < until && s[pos] >= 0x80);
+                }
+                return written;
+            }
+
+
+            /// Transcode UTF-8 that may be invalid. Each byte that can't be
+            /// decoded is replaced by U+FFFD. The output must be at least as
+            /// long as the input.
+            inline std::size_t u8u16_replacing(
+                    unsigned char const *const s,
+                    std::size_t const size,
+                    utf16 *const out) noexcept {
+                std::size_t pos{}, written{};
+                while (pos < size) {
+                    auto const good = pos
+                            + valid_length(const_u8buffer{
+                                    reinterpret_cast<char const *>(s + pos),
+                                    size - pos});
+                    written += u8u16(
+                            s + pos, good - pos, out + written, good - pos);
+                    if (good < size) { out[written++] = 0xfffd; }
+                    pos = good + 1u;
+                }
+                return written;
+            }
+
+
+            /// Decode a code point from UTF-16 that is known to be valid
+            inline utf32 u16decode_valid(
+                    utf16 const *const s, std::size_t &pos) noexcept {
+                utf32 const u = s[pos++];
+                if (u >= 0xd800 && u <= 0xdbff) {
+                    return ((u - 0xd800) << 10) + (s[pos++] - 0xdc00) + 0x10000;
+                } else {
+                    return u;
+                }
+            }
+
+
+            /// Write the UTF-8 for a valid code point, returning the number
+            /// of bytes used
+            inline std::size_t u8write(utf32 const cp, char *const out) noexcept {
+                if (cp < 0x80) {
+                    out[0] = static_cast<char>(cp);
+                    return 1u;
+                } else if (cp < 0x800) {
+                    out[0] = static_cast<char>(0xc0 | (cp >> 6));
+                    out[1] = static_cast<char>(0x80 | (cp & 0x3f));
+                    return 2u;
+                } else if (cp < 0x1'0000) {
+                    out[0] = static_cast<char>(0xe0 | (cp >> 12));
+                    out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+                    out[2] = static_cast<char>(0x80 | (cp & 0x3f));
+                    return 3u;
+                } else {
+                    out[0] = static_cast<char>(0xf0 | (cp >> 18));
+                    out[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+                    out[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+                    out[3] = static_cast<char>(0x80 | (cp & 0x3f));
+                    return 4u;
+                }
+            }
+
+
+            /// The number of UTF-8 bytes needed for valid UTF-16. Every code
+            /// unit needs at least one byte, those from U+0080 need another
+            /// and those from U+0800 a third. Surrogates are two bytes each so
+            /// a pair makes up four.
+            inline std::size_t u16u8length(
+                    utf16 const *const s, std::size_t const size) noexcept {
+                std::size_t bytes{size}, pos{};
+#if defined(F5_CORD_SIMD_SSE42)
+                using V = simd::native;
+                auto const zero = V::zero(), two = V::splat16(0xff80),
+                           three = V::splat16(0xf800),
+                           surrogate = V::splat16(0xd800);
+                for (; size - pos >= V::width / 2; pos += V::width / 2) {
+                    auto const v = V::load(s + pos);
+                    auto const high = V::bit_and(v, three);
+                    bytes += (2u * V::width
+                              - simd::popcount(
+                                      V::equal16(V::bit_and(v, two), zero))
+                              - simd::popcount(V::equal16(high, zero))
+                              - simd::popcount(V::equal16(high, surrogate)))
+                            / 2u;
+                }
+#endif
+                for (; pos < size; ++pos) {
+                    if (s[pos] >= 0x80) ++bytes;
+                    if (s[pos] >= 0x800 && not is_surrogate(s[pos])) ++bytes;
+                }
+                return bytes;
+            }
+
+
+            /// Transcode valid UTF-16 to UTF-8. The output must have space
+            /// for the result. Blocks of ASCII are narrowed a vector at a
+            /// time, anything else is decoded a code point at a time to the
+            /// end of the block.
+            inline std::size_t u16u8(
+                    utf16 const *const s,
+                    std::size_t const size,
+                    char *const out) noexcept {
+#if defined(F5_CORD_SIMD_SSE42)
+                using V = simd::native;
+                constexpr std::size_t block = V::width;
+                auto const ascii = V::splat16(0xff80);
+#else
+                constexpr std::size_t block = 4u;
+#endif
+                std::size_t pos{}, written{};
+                while (pos < size) {
+                    if (size - pos >= block) {
+#if defined(F5_CORD_SIMD_SSE42)
+                        auto const l = V::load(s + pos),
+                                   h = V::load(s + pos + block / 2);
+                        if (not V::any(V::bit_and(V::bit_or(l, h), ascii))) {
+                            V::store(out + written, V::pack16(l, h));
+                            pos += block;
+                            written += block;
+                            continue;
+                        }
+#else
+                        if (((s[pos] | s[pos + 1] | s[pos + 2] | s[pos + 3])
+                             & 0xff80)
+                            == 0) {
+                            for (std::size_t c{}; c < block; ++c) {
+                                out[written + c] = static_cast<char>(s[pos + c]);
+                            }
+                            pos += block;
+                            written += block;
+                            continue;
+                        }
+#endif
+                    }
+                    auto const until = std::min(size, pos + block);
+                    while (pos < until) {
+                        written += u8write(u16decode_valid(s, pos), out + written);
+                    }
+                }
+                return written;
+            }
+
+
+            /// Transcode UTF-16 that may contain unpaired surrogates. Each of
+            /// these is replaced by U+FFFD. The output must have three bytes
+            /// for each input code unit.
+            inline std::size_t u16u8_replacing(
+                    utf16 const *const s,
+                    std::size_t const size,
+                    char *const out) noexcept {
+                std::size_t pos{}, written{};
+                while (pos < size) {
+                    auto const good =
+                            pos + u16valid_length(s + pos, size - pos);
+                    written += u16u8(s + pos, good - pos, out + written);
+                    if (good < size) { written += u8write(0xfffd, out + written); }
+                    pos = good + 1u;
+                }
+                return written;
+            }
+
+
+            /// Decode valid UTF-8 into UTF-32, stopping when either the input
+            /// is used up or the output is full. `pos` is moved past the
+            /// input that was decoded and the number of code points written
+            /// is returned. ASCII is widened a vector at a time.
+            inline std::size_t u8u32(
+                    unsigned char const *const s,
+                    std::size_t const size,
+                    std::size_t &pos,
+                    utf32 *const out,
+                    std::size_t const capacity) noexcept {
+                std::size_t written{};
+                while (pos < size && written < capacity) {
+#if defined(F5_CORD_SIMD_SSE42)
+                    using V = simd::native;
+                    if (size - pos >= V::width
+                        && capacity - written >= V::width) {
+                        auto const v = V::load(s + pos);
+                        auto const high = V::high_bits(v);
+                        auto const ascii = high ? simd::lowest(high) : V::width;
+                        V::store32(out + written, v);
+                        pos += ascii;
+                        written += ascii;
+                        if (not high) continue;
+                    }
+#endif
+                    out[written++] = u8decode_valid(s, pos);
+                }
+                return written;
+            }
+
+
+            /// Returns `true` if the bytes from `pos` to the end of the
+            /// buffer are the start of a valid sequence that has been cut
+            /// short. The two filler bytes between them satisfy the range
+            /// for the second byte after every lead byte.
+            inline bool u8truncated(
+                    unsigned char const *const s,
+                    std::size_t const size,
+                    std::size_t const pos) noexcept {
+                auto const remaining = size - pos;
+                if (remaining == 0u || remaining > 3u) return false;
+                for (unsigned char const filler : {0x80, 0xa0}) {
+                    unsigned char completed[4] = {filler, filler, filler, filler};
+                    std::memcpy(completed, s + pos, remaining);
+                    for (auto length = remaining + 1u; length <= 4u; ++length) {
+                        if (u8valid_length(completed, length) == length) {
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+
+
+            /// The number of UTF-8 bytes needed for valid UTF-32
+            inline std::size_t u32u8length(
+                    utf32 const *const s, std::size_t const size) noexcept {
+                std::size_t bytes{size};
+                for (std::size_t pos{}; pos < size; ++pos) {
+                    bytes += (s[pos] >= 0x80) + (s[pos] >= 0x800)
+                            + (s[pos] >= 0x1'0000);
+                }
+                return bytes;
+            }
+
+
+        }
+
+
+        /// ## Block decoding and encoding
+
+        /// Decode UTF-8 into UTF-32 code points. Decoding stops when the
+        /// input is used up or the output is full, and the number of bytes
+        /// consumed and code points produced are returned. A sequence that
+        /// is cut short at the end of the input is not consumed so the
+        /// caller can carry it over to the next block.
+        ///
+        /// Invalid sequences raise an `E`. When `E` is `void` each byte that
+        /// can't be decoded produces a U+FFFD instead.
+        template<typename E = std::range_error>
+        inline std::pair<std::size_t, std::size_t>
+                decode_into(const_u8buffer const in, buffer<utf32> out) {
+            auto const s = reinterpret_cast<unsigned char const *>(in.data());
+            auto const size = in.size(), capacity = out.size();
+            std::size_t pos{}, written{};
+            while (pos < size && written < capacity) {
+                /// No code point needs more than four bytes, so only that
+                /// much of the input needs to be checked
+                auto const window =
+                        std::min(size - pos, 4u * (capacity - written) + 4u);
+                auto const good = pos + valid_length(in.slice(pos, window));
+                written += detail::u8u32(
+                        s, good, pos, out.data() + written, capacity - written);
+                if (pos < good || pos == size || written == capacity) {
+                    break;
+                } else if (detail::u8truncated(s, size, pos)) {
+                    break;
+                } else if (
+                        detail::u8valid_length(s, std::min(size, pos + 4u), pos)
+                        > pos) {
+                    /// The window finished part way through a code point
+                    continue;
+                }
+                raise_encoding<E>("Invalid UTF-8 found when decoding");
+                out[written++] = 0xfffd;
+                ++pos;
+            }
+            return {pos, written};
+        }
+
+
+        /// Encode UTF-32 code points as UTF-8. Encoding stops when the input
+        /// is used up or there is no room in the output for the next code
+        /// point, and the number of code points consumed and bytes produced
+        /// are returned. Blocks of ASCII are narrowed a vector at a time.
+        ///
+        /// Surrogates and values past U+10FFFF raise an `E`, or are encoded
+        /// as U+FFFD when `E` is `void`.
+        template<typename E = std::range_error>
+        inline std::pair<std::size_t, std::size_t>
+                encode_into(const_u32buffer const in, buffer<utf8> out) {
+            auto const s = in.data();
+            auto const size = in.size(), capacity = out.size();
+            std::size_t pos{}, written{};
+#if defined(F5_CORD_SIMD_SSE42)
+            using V = simd::native;
+            constexpr std::size_t block = V::width;
+            auto const ascii = V::splat32(0xffff'ff80);
+#else
+            constexpr std::size_t block = 4u;
+#endif
+            while (pos < size) {
+                if (size - pos >= block && capacity - written >= block) {
+#if defined(F5_CORD_SIMD_SSE42)
+                    constexpr std::size_t q = block / 4u;
+                    auto const a = V::load(s + pos), b = V::load(s + pos + q),
+                               c = V::load(s + pos + 2u * q),
+                               d = V::load(s + pos + 3u * q);
+                    if (not V::any(V::bit_and(
+                                V::bit_or(V::bit_or(a, b), V::bit_or(c, d)),
+                                ascii))) {
+                        V::store(
+                                out.data() + written,
+                                V::pack16(V::pack32(a, b), V::pack32(c, d)));
+                        pos += block;
+                        written += block;
+                        continue;
+                    }
+#else
+                    if (((s[pos] | s[pos + 1] | s[pos + 2] | s[pos + 3])
+                         & 0xffff'ff80)
+                        == 0) {
+                        for (std::size_t c{}; c < block; ++c) {
+                            out[written + c] = static_cast<char>(s[pos + c]);
+                        }
+                        pos += block;
+                        written += block;
+                        continue;
+                    }
+#endif
+                }
+                auto const until = std::min(size, pos + block);
+                for (; pos < until; ++pos) {
+                    auto cp = s[pos];
+                    if (not check_valid<void>(cp)) {
+                        raise_encoding<E>(
+                                "Invalid code point found when encoding");
+                        cp = 0xfffd;
+                    }
+                    auto const length = 1u + (cp >= 0x80) + (cp >= 0x800)
+                            + (cp >= 0x1'0000);
+                    if (capacity - written < length) {
+                        return {pos, written};
+                    }
+                    written += detail::u8write(cp, out.data() + written);
+                }
+            }
+            return {pos, written};
+        }
+
+
+        namespace detail {
+
+
+            /// Transcode a view into another encoding. The input is
+            /// validated and the length of the output worked out so that
+            /// `allocate` (which is given the number of code units needed
+            /// and returns where to write them) can be called once with
+            /// exactly the right size. The number of code units written is
+            /// returned. Encoding pairs that have no bulk conversion go
+            /// through the view's iterators.
+            template<typename To, typename E, typename From, typename A>
+            inline std::size_t
+                    transcoded(basic_view<From> const v, A &&allocate) {
+                static_assert(
+                        not std::is_same_v<To, From>,
+                        "Transcoding must be to a different encoding");
+                auto const in = static_cast<buffer<From const>>(v);
+                if constexpr (
+                        std::is_same_v<From, utf8> && std::is_same_v<To, utf16>) {
+                    auto const s =
+                            reinterpret_cast<unsigned char const *>(in.data());
+                    if (valid_length(in) == in.size()) {
+                        auto const length = u8u16length(in.data(), in.size());
+                        return u8u16(s, in.size(), allocate(length), length);
+                    } else {
+                        raise_encoding<E>(
+                                "Invalid UTF-8 found when transcoding to "
+                                "UTF-16");
+                        return u8u16_replacing(
+                                s, in.size(), allocate(in.size()));
+                    }
+                } else if constexpr (
+                        std::is_same_v<From, utf16> && std::is_same_v<To, utf8>) {
+                    if (valid_length(in) == in.size()) {
+                        return u16u8(
+                                in.data(), in.size(),
+                                allocate(u16u8length(in.data(), in.size())));
+                    } else {
+                        raise_encoding<E>(
+                                "Unpaired surrogate found when transcoding to "
+                                "UTF-8");
+                        return u16u8_replacing(
+                                in.data(), in.size(), allocate(3u * in.size()));
+                    }
+                } else if constexpr (
+                        std::is_same_v<From, utf8> && std::is_same_v<To, utf32>) {
+                    if (valid_length(in) == in.size()) {
+                        auto const length = count_code_points(in);
+                        std::size_t pos{};
+                        return u8u32(
+                                reinterpret_cast<unsigned char const *>(
+                                        in.data()),
+                                in.size(), pos, allocate(length), length);
+                    } else {
+                        raise_encoding<E>(
+                                "Invalid UTF-8 found when transcoding to "
+                                "UTF-32");
+                        auto const out = allocate(in.size());
+                        auto const [consumed, produced] = decode_into<void>(
+                                in, buffer<utf32>{out, in.size()});
+                        /// Anything left over is a truncated sequence
+                        auto const size = produced + in.size() - consumed;
+                        std::fill(out + produced, out + size, 0xfffd);
+                        return size;
+                    }
+                } else if constexpr (
+                        std::is_same_v<From, utf32> && std::is_same_v<To, utf8>) {
+                    std::size_t length{};
+                    if (valid_length(in) == in.size()) {
+                        length = u32u8length(in.data(), in.size());
+                    } else {
+                        raise_encoding<E>(
+                                "Invalid code point found when transcoding to "
+                                "UTF-8");
+                        length = 4u * in.size();
+                    }
+                    return encode_into<void>(
+                                   in, buffer<utf8>{allocate(length), length})
+                            .second;
+                } else {
+                    /// Between UTF-16 and UTF-32 each code point needs at
+                    /// most two UTF-16 code units
+                    auto const out =
+                            allocate(in.size() * (sizeof(To) == 2u ? 2u : 1u));
+                    std::size_t written{};
+                    for (auto const u32 : basic_view<From, E>{in}) {
+                        auto const en = iterators<To, E>::encode_one(u32);
+                        for (char c{}; c < en.first; ++c) {
+                            out[written++] = en.second[c];
+                        }
+                    }
+                    return written;
+                }
+            }
+
+
+        }
+
+
+        /// ## Transcoding
+
+        /// Transcode the UTF-8 into the UTF-16 buffer, returning the part of
+        /// the buffer that was used. A buffer the same size as the input is
+        /// always large enough.
+        ///
+        /// If the input is not valid an `E` is raised. When `E` is `void`
+        /// invalid bytes are replaced by U+FFFD. If the output is too small an
+        /// `L` is raised (or an empty buffer returned).
+        template<typename E = std::range_error, typename L = std::length_error>
+        inline u16buffer transcode(const_u8buffer const in, u16buffer out) {
+            auto const s = reinterpret_cast<unsigned char const *>(in.data());
+            if (valid_length(in) == in.size()) {
+                if (out.size() < in.size()
+                    && out.size() < detail::u8u16length(in.data(), in.size())) {
+                    raise<L>("Output buffer is too small to hold the UTF-16");
+                    return {};
+                }
+                return out.slice(
+                        0,
+                        detail::u8u16(s, in.size(), out.data(), out.size()));
+            } else {
+                raise_encoding<E>(
+                        "Invalid UTF-8 found when transcoding to UTF-16");
+                if (out.size() < in.size()) {
+                    raise<L>("Output buffer is too small to hold the UTF-16");
+                    return {};
+                }
+                return out.slice(
+                        0, detail::u8u16_replacing(s, in.size(), out.data()));
+            }
+        }
+
+
+        /// Transcode the UTF-16 into the UTF-8 buffer, returning the part of
+        /// the buffer that was used. A buffer three times the length of the
+        /// input is always large enough. Unpaired surrogates raise an `E`, or
+        /// are replaced by U+FFFD if it is `void`.
+        template<typename E = std::range_error, typename L = std::length_error>
+        inline u8buffer transcode(const_u16buffer const in, u8buffer out) {
+            if (valid_length(in) == in.size()) {
+                if (out.size() < 3u * in.size()
+                    && out.size() < detail::u16u8length(in.data(), in.size())) {
+                    raise<L>("Output buffer is too small to hold the UTF-8");
+                    return {};
+                }
+                return out.slice(0, detail::u16u8(in.data(), in.size(), out.data()));
+            } else {
+                raise_encoding<E>(
+                        "Unpaired surrogate found when transcoding to UTF-8");
+                if (out.size() < 3u * in.size()) {
+                    raise<L>("Output buffer is too small to hold the UTF-8");
+                    return {};
+                }
+                return out.slice(
+                        0,
+                        detail::u16u8_replacing(
+                                in.data(), in.size(), out.data()));
+            }
+        }
+
+
+        namespace detail {
+
+
+            /// Compile time decoding of the code point at `pos` in a UTF-16
+            /// or UTF-32 literal. An unpaired surrogate is returned as is, so
+            /// it will fail `check_valid`.
+            template<typename C>
+            constexpr inline utf32 literal_decode(
+                    C const *const s, std::size_t const size, std::size_t &pos) {
+                utf32 const u = s[pos++];
+                if constexpr (std::is_same_v<C, utf16>) {
+                    if (u >= 0xd800 && u <= 0xdbff && pos < size
+                        && s[pos] >= 0xdc00 && s[pos] <= 0xdfff) {
+                        return ((u - 0xd800) << 10) + (s[pos++] - 0xdc00)
+                                + 0x10000;
+                    }
+                }
+                return u;
+            }
+            template<typename C>
+            constexpr inline bool
+                    literal_valid(C const *const s, std::size_t const size) {
+                for (std::size_t pos{}; pos < size;) {
+                    if (not check_valid<void>(literal_decode(s, size, pos))) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            /// The number of UTF-8 bytes needed, invalid code points are
+            /// counted as U+FFFD
+            template<typename C>
+            constexpr inline std::size_t
+                    literal_u8length(C const *const s, std::size_t const size) {
+                std::size_t bytes{};
+                for (std::size_t pos{}; pos < size;) {
+                    auto const cp = literal_decode(s, size, pos);
+                    bytes += check_valid<void>(cp) ? u8length<void>(cp) : 3u;
+                }
+                return bytes;
+            }
+            template<std::size_t N, typename C>
+            constexpr inline std::array<char, N + 1>
+                    literal_u8encode(C const *const s, std::size_t const size) {
+                std::array<char, N + 1> out{};
+                std::size_t written{};
+                for (std::size_t pos{}; pos < size;) {
+                    auto cp = literal_decode(s, size, pos);
+                    if (not check_valid<void>(cp)) cp = 0xfffd;
+                    auto const en = u8encode<void>(cp);
+                    for (char c{}; c < en.first; ++c) {
+                        out[written++] = en.second[c];
+                    }
+                }
+                return out;
+            }
+
+
+            /// A UTF-16 or UTF-32 literal transcoded to UTF-8 at compile
+            /// time. The bytes are NUL terminated.
+            template<typename C, C... Text>
+            struct u8literal {
+                static constexpr C text[sizeof...(Text) + 1] = {Text..., 0};
+                static constexpr bool valid =
+                        literal_valid(text, sizeof...(Text));
+                static constexpr std::size_t size =
+                        literal_u8length(text, sizeof...(Text));
+                static constexpr std::array<char, size + 1> encoded =
+                        literal_u8encode<size>(text, sizeof...(Text));
+            };
+            /// The encoded bytes as an array that an `lstring` can refer to
+            template<
+                    typename L,
+                    typename = std::make_index_sequence<L::size + 1>>
+            struct u8literal_storage;
+            template<typename L, std::size_t... I>
+            struct u8literal_storage<L, std::index_sequence<I...>> {
+                static constexpr char bytes[sizeof...(I)] = {L::encoded[I]...};
+            };
+
+
+        }
+
+
+    }
+
+
+}
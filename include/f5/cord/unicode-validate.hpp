@@ -0,0 +1,335 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/cord/simd.hpp>
+#include <f5/cord/unicode-view.hpp>
+
+
+namespace f5 {
+
+
+    namespace cord {
+
+
+        namespace detail {
+
+
+            /// The number of bytes in the sequence started by `lead`, and
+            /// the range the byte after it must be in. The length is zero
+            /// for bytes that can't start a sequence.
+            struct u8lead_type {
+                std::size_t length;
+                unsigned char low = 0x80, high = 0xbf;
+            };
+            constexpr u8lead_type u8lead(unsigned char const lead) noexcept {
+                if (lead < 0x80) {
+                    return {1u};
+                } else if (lead < 0xc2) {
+                    return {0u};
+                } else if (lead < 0xe0) {
+                    return {2u};
+                } else if (lead == 0xe0) {
+                    return {3u, 0xa0};
+                } else if (lead == 0xed) {
+                    return {3u, 0x80, 0x9f};
+                } else if (lead < 0xf0) {
+                    return {3u};
+                } else if (lead == 0xf0) {
+                    return {4u, 0x90};
+                } else if (lead == 0xf4) {
+                    return {4u, 0x80, 0x8f};
+                } else if (lead < 0xf5) {
+                    return {4u};
+                } else {
+                    return {0u};
+                }
+            }
+
+            /// Strict scalar UTF-8 validation following table 3-7 of the
+            /// Unicode standard. Overlong forms, encoded surrogates and
+            /// values beyond U+10FFFF are all rejected. Returns the number of
+            /// bytes from the start of the buffer that are made up of
+            /// complete and valid code points. Starting at `pos` is only
+            /// safe if it is on a code point boundary.
+            inline std::size_t u8valid_length(
+                    unsigned char const *const s,
+                    std::size_t const size,
+                    std::size_t pos = 0u) noexcept {
+                while (pos < size) {
+                    if (pos + 8u <= size && simd::is_ascii(simd::load64(s + pos))) {
+                        pos += 8u;
+                        continue;
+                    }
+                    if (s[pos] < 0x80) {
+                        ++pos;
+                        continue;
+                    }
+                    auto const [length, low, high] = u8lead(s[pos]);
+                    if (length == 0u || size - pos < length) return pos;
+                    if (s[pos + 1] < low || s[pos + 1] > high) return pos;
+                    for (std::size_t c{2u}; c < length; ++c) {
+                        if ((s[pos + c] & 0xc0) != 0x80) return pos;
+                    }
+                    pos += length;
+                }
+                return pos;
+            }
+
+
+#if defined(F5_CORD_SIMD_SSE42)
+            /**
+                Vectorised validation based on the "lookup" algorithm of
+                Keiser and Lemire. Each byte is classified by three 16
+                entry tables indexed by the high and low nibbles of the
+                previous byte and the high nibble of the current one. Any
+                bit set in all three means an error. The lengths of three
+                and four byte sequences are checked separately using the
+                bytes two and three positions back.
+             */
+            template<typename V>
+            struct u8checker {
+                using vector = typename V::vector;
+
+                static constexpr std::uint8_t too_short = 1u << 0;
+                static constexpr std::uint8_t too_long = 1u << 1;
+                static constexpr std::uint8_t overlong_3 = 1u << 2;
+                static constexpr std::uint8_t too_large = 1u << 3;
+                static constexpr std::uint8_t surrogate = 1u << 4;
+                static constexpr std::uint8_t overlong_2 = 1u << 5;
+                static constexpr std::uint8_t too_large_1000 = 1u << 6;
+                static constexpr std::uint8_t overlong_4 = 1u << 6;
+                static constexpr std::uint8_t two_conts = 1u << 7;
+                static constexpr std::uint8_t carry =
+                        too_short | too_long | two_conts;
+
+                vector const byte_1_high, byte_1_low, byte_2_high, max_lead;
+                vector previous = V::zero(), incomplete = V::zero();
+
+                u8checker() noexcept
+                : byte_1_high{V::table(byte_1_high_table)},
+                  byte_1_low{V::table(byte_1_low_table)},
+                  byte_2_high{V::table(byte_2_high_table)},
+                  max_lead{V::load(max_lead_table + 64 - V::width)} {}
+
+                /// Check the next block of input. Returns `false` if the
+                /// block contains an error, or completes an error started in
+                /// the previous block.
+                bool check(vector const input) noexcept {
+                    vector error;
+                    if (V::is_ascii(input)) {
+                        error = incomplete;
+                        incomplete = V::zero();
+                    } else {
+                        auto const prev1 = V::template prev<1>(input, previous);
+                        auto const special = V::bit_and(
+                                V::bit_and(
+                                        V::lookup(
+                                                byte_1_high,
+                                                V::high_nibbles(prev1)),
+                                        V::lookup(
+                                                byte_1_low,
+                                                V::low_nibbles(prev1))),
+                                V::lookup(
+                                        byte_2_high, V::high_nibbles(input)));
+                        auto const prev2 = V::template prev<2>(input, previous);
+                        auto const prev3 = V::template prev<3>(input, previous);
+                        auto const third = V::saturating_sub(
+                                prev2, V::splat(0xe0 - 0x80));
+                        auto const fourth = V::saturating_sub(
+                                prev3, V::splat(0xf0 - 0x80));
+                        auto const must23 = V::bit_and(
+                                V::bit_or(third, fourth), V::splat(0x80));
+                        error = V::bit_xor(must23, special);
+                        incomplete = V::saturating_sub(input, max_lead);
+                    }
+                    previous = input;
+                    return not V::any(error);
+                }
+
+                static constexpr std::uint8_t byte_1_high_table[16] = {
+                        too_long,
+                        too_long,
+                        too_long,
+                        too_long,
+                        too_long,
+                        too_long,
+                        too_long,
+                        too_long,
+                        two_conts,
+                        two_conts,
+                        two_conts,
+                        two_conts,
+                        too_short | overlong_2,
+                        too_short,
+                        too_short | overlong_3 | surrogate,
+                        too_short | too_large | too_large_1000 | overlong_4};
+                static constexpr std::uint8_t byte_1_low_table[16] = {
+                        carry | overlong_3 | overlong_2 | overlong_4,
+                        carry | overlong_2,
+                        carry,
+                        carry,
+                        carry | too_large,
+                        carry | too_large | too_large_1000,
+                        carry | too_large | too_large_1000,
+                        carry | too_large | too_large_1000,
+                        carry | too_large | too_large_1000,
+                        carry | too_large | too_large_1000,
+                        carry | too_large | too_large_1000,
+                        carry | too_large | too_large_1000,
+                        carry | too_large | too_large_1000,
+                        carry | too_large | too_large_1000 | surrogate,
+                        carry | too_large | too_large_1000,
+                        carry | too_large | too_large_1000};
+                static constexpr std::uint8_t byte_2_high_table[16] = {
+                        too_short,
+                        too_short,
+                        too_short,
+                        too_short,
+                        too_short,
+                        too_short,
+                        too_short,
+                        too_short,
+                        too_long | overlong_2 | two_conts | overlong_3
+                                | too_large_1000 | overlong_4,
+                        too_long | overlong_2 | two_conts | overlong_3
+                                | too_large,
+                        too_long | overlong_2 | two_conts | surrogate
+                                | too_large,
+                        too_long | overlong_2 | two_conts | surrogate
+                                | too_large,
+                        too_short,
+                        too_short,
+                        too_short,
+                        too_short};
+                /// Any lead byte in the last three positions of a block
+                /// that needs more bytes than are left in the block will
+                /// be greater than these values
+                static constexpr std::uint8_t max_lead_table[64] = {
+                        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                        0xff, 0xff, 0xff, 0xff, 0xff, 0xef, 0xdf, 0xbf};
+            };
+
+
+            /// Vectorised version of `u8valid_length`. The fast path only
+            /// knows that a block is bad, so once one is found we back up to
+            /// the last code point boundary and let the scalar code find
+            /// exactly where the problem is.
+            template<typename V>
+            inline std::size_t u8valid_length_simd(
+                    unsigned char const *const s, std::size_t const size) noexcept {
+                auto const restart = [s, size](std::size_t const pos) {
+                    std::size_t start = pos;
+                    while (start > 0u && pos - start < 4u) {
+                        --start;
+                        if ((s[start] & 0xc0) != 0x80) break;
+                    }
+                    return u8valid_length(s, size, start);
+                };
+                u8checker<V> checker;
+                std::size_t pos{};
+                for (; size - pos >= V::width; pos += V::width) {
+                    if (not checker.check(V::load(s + pos))) {
+                        return restart(pos);
+                    }
+                }
+                /// The tail is padded with NUL, which also catches any
+                /// truncated sequence at the very end of the input
+                unsigned char tail[V::width] = {};
+                if (size - pos) std::memcpy(tail, s + pos, size - pos);
+                if (not checker.check(V::load(tail))) { return restart(pos); }
+                return size;
+            }
+#endif
+
+
+            /// UTF-16 is valid if all surrogates are correctly paired
+            inline std::size_t u16valid_length(
+                    utf16 const *const s, std::size_t const size) noexcept {
+                std::size_t pos{};
+                while (pos < size) {
+                    if (not is_surrogate(s[pos])) {
+                        ++pos;
+                    } else if (
+                            s[pos] <= 0xdbff && size - pos >= 2u
+                            && s[pos + 1] >= 0xdc00 && s[pos + 1] <= 0xdfff) {
+                        pos += 2u;
+                    } else {
+                        return pos;
+                    }
+                }
+                return pos;
+            }
+
+
+            /// UTF-32 is valid if every code point is
+            inline std::size_t u32valid_length(
+                    utf32 const *const s, std::size_t const size) noexcept {
+                std::size_t pos{};
+                for (; pos < size; ++pos) {
+                    if (not check_valid<void>(s[pos])) return pos;
+                }
+                return pos;
+            }
+
+
+        }
+
+
+        /// ## Validation
+
+        /// Returns the number of code units at the start of the buffer that
+        /// make up complete and valid code points. If this is equal to the
+        /// buffer size then the whole buffer is valid.
+        inline std::size_t valid_length(const_u8buffer const b) noexcept {
+            auto const s = reinterpret_cast<unsigned char const *>(b.data());
+#if defined(F5_CORD_SIMD_SSE42)
+            return detail::u8valid_length_simd<simd::native>(s, b.size());
+#else
+            return detail::u8valid_length(s, b.size());
+#endif
+        }
+        inline std::size_t valid_length(const_u16buffer const b) noexcept {
+            return detail::u16valid_length(b.data(), b.size());
+        }
+        inline std::size_t valid_length(const_u32buffer const b) noexcept {
+            return detail::u32valid_length(b.data(), b.size());
+        }
+
+
+        /// Returns `true` if the whole of the string is correctly encoded
+        inline bool validate(u8view const v) noexcept {
+            return valid_length(static_cast<const_u8buffer>(v)) == v.code_units();
+        }
+        inline bool validate(u16view const v) noexcept {
+            return valid_length(static_cast<const_u16buffer>(v)) == v.code_units();
+        }
+        inline bool validate(u32view const v) noexcept {
+            return valid_length(static_cast<const_u32buffer>(v)) == v.code_units();
+        }
+
+
+        /// Tag used to ask for the encoding to be checked on construction
+        struct checked_t {
+            explicit constexpr checked_t() = default;
+        };
+        inline constexpr checked_t checked{};
+
+
+    }
+
+
+}
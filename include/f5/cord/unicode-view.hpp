@@ -13,11 +13,17 @@
 #include <f5/detect.hpp>
 #include <f5/memory.hpp>
 #include <f5/cord/lstring.hpp>
+#include <f5/cord/unicode-count.hpp>
 #include <f5/cord/unicode-encodings.hpp>
 #include <f5/cord/unicode-iterators.hpp>
+#include <f5/cord/unicode-search.hpp>
 
 #include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <iterator>
+#include <limits>
+#include <optional>
 
 #ifndef assert
 #include <cassert>
@@ -30,14 +36,100 @@ namespace f5 {
     namespace cord {
 
 
-        /// String views for any Unicode code unit type
+        namespace detail {
+
+
+#if defined(F5_CORD_HASH_CACHE) || defined(F5_CORD_CODE_POINT_INDEX)
+            /// The `user_data` of a string's control block when
+            /// `F5_CORD_HASH_CACHE` or `F5_CORD_CODE_POINT_INDEX` is
+            /// defined. It is the number of code units used in the
+            /// allocation, as without them, plus slots for the hash of
+            /// those code units (zero until it has been worked out) and for
+            /// their code point index (built when first needed).
+            struct string_size {
+                std::size_t size;
+#if defined(F5_CORD_HASH_CACHE)
+                mutable std::atomic<std::uint64_t> hash = 0u;
+#endif
+#if defined(F5_CORD_CODE_POINT_INDEX)
+                mutable std::atomic<u8index const *> index = nullptr;
+#endif
+
+                string_size(std::size_t const s) noexcept : size{s} {}
+                /// Only made as the control block is, so there is never an
+                /// index to copy
+                string_size(string_size const &s) noexcept
+                : size{s.size}
+#if defined(F5_CORD_HASH_CACHE)
+                  ,
+                  hash{s.hash.load(std::memory_order_relaxed)}
+#endif
+                {
+                }
+                /// Only set before anything can have been indexed
+                string_size &operator=(std::size_t const s) noexcept {
+                    size = s;
+#if defined(F5_CORD_HASH_CACHE)
+                    hash.store(0u, std::memory_order_relaxed);
+#endif
+                    return *this;
+                }
+#if defined(F5_CORD_CODE_POINT_INDEX)
+                ~string_size() { delete index.load(std::memory_order_relaxed); }
+#endif
+                operator std::size_t() const noexcept { return size; }
+            };
+#else
+            using string_size = std::size_t;
+#endif
+
+
+#if defined(F5_CORD_CODE_POINT_INDEX)
+            /// UTF-8 strings at least this many code units long are
+            /// indexed the first time a substring is taken by code point
+            inline constexpr std::size_t index_threshold = 4096u;
+
+            /// The code point index for the allocation the view is part of.
+            /// It is built if there isn't one yet and the view covers the
+            /// whole allocation.
+            template<typename Control>
+            inline u8index const *code_point_index(
+                    Control *const owner,
+                    char const *const data,
+                    std::size_t const size) {
+                if (not owner) return nullptr;
+                auto &slot = owner->user_data.index;
+                if (auto const index = slot.load(std::memory_order_acquire)) {
+                    return index->covers(data) ? index : nullptr;
+                } else if (size < index_threshold || owner->user_data != size) {
+                    return nullptr;
+                }
+                auto made = std::make_unique<u8index const>(data, size);
+                u8index const *expected = nullptr;
+                if (slot.compare_exchange_strong(
+                            expected, made.get(), std::memory_order_acq_rel)) {
+                    return made.release();
+                } else {
+                    return expected;
+                }
+            }
+#endif
+
+
+        }
+
+
+        /// String views for any Unicode code unit type. `R` is how the
+        /// control blocks are reference counted, see
+        /// [control.hpp](../control.hpp).
         template<
                 typename C,
                 typename E = std::range_error,
-                typename IM = iterators<C, E>>
+                typename IM = iterators<C, E>,
+                typename R = atomic_count>
         class basic_view {
             f5::buffer<const C> buffer;
-            control<std::size_t> *owner = nullptr;
+            control<detail::string_size, R> *owner = nullptr;
 
           public:
             /// ## Types
@@ -116,7 +208,18 @@ namespace f5 {
             /// Return the end iterator that delivers UTF32 code points
             constexpr const_iterator end() const {
                 return IM::template make_iterator<buffer_type, control_type>(
-                        buffer.slice(buffer.size()), owner);
+                        buffer, buffer.size(), owner);
+            }
+
+            /// The iterators can also be moved backwards, decoding from the
+            /// end of the string
+            using const_reverse_iterator =
+                    std::reverse_iterator<const_iterator>;
+            constexpr const_reverse_iterator rbegin() const {
+                return const_reverse_iterator{end()};
+            }
+            constexpr const_reverse_iterator rend() const {
+                return const_reverse_iterator{begin()};
             }
 
             /// Construct a basic_view from part of another
@@ -149,7 +252,7 @@ namespace f5 {
             bool is_shared() const noexcept { return owner != nullptr; }
             /// Returns true if the other string uses the same allocation
             /// as this (they have the same control block).
-            bool shares_allocation_with(basic_view v) noexcept {
+            bool shares_allocation_with(basic_view v) const noexcept {
                 return owner != nullptr && owner == v.owner;
             }
             /// Return the memory control block
@@ -167,8 +270,11 @@ namespace f5 {
             constexpr std::size_t code_units() const noexcept {
                 return buffer.size();
             }
-            /// Return the size in code points
-            auto code_points() const { return std::distance(begin(), end()); }
+            /// Return the size in code points. The count is made directly on
+            /// the code units and doesn't check the encoding.
+            std::size_t code_points() const noexcept {
+                return count_code_points(buffer);
+            }
             /// Return true if the view is empty
             constexpr bool empty() const noexcept { return buffer.empty(); }
             /// Return the underlying memory block for the data
@@ -184,17 +290,52 @@ namespace f5 {
             /// Safe substring against Unicode code point counts. The result
             /// is undefined if the end marker is smaller than the start marker.
             basic_view substr(std::size_t s) const {
+                if (auto const indexed = index_substr(s, npos)) {
+                    return *indexed;
+                }
                 auto pos = begin(), e = end();
-                for (; s && pos != e; --s, ++pos)
-                    ;
+                IM::advance(pos, e, s);
                 return basic_view(pos, e);
             }
             basic_view substr_pos(std::size_t s, std::size_t e) const {
-                auto starts = substr(s);
-                auto ends = starts.substr(e - s);
-                return basic_view{starts.begin(), ends.begin()};
+                if (auto const indexed = index_substr(s, e)) {
+                    return *indexed;
+                }
+                auto starts = begin();
+                auto const last = end();
+                IM::advance(starts, last, s);
+                auto ends = starts;
+                IM::advance(ends, last, e - s);
+                return basic_view{starts, ends};
+            }
+
+          private:
+            /// When `F5_CORD_CODE_POINT_INDEX` is defined long UTF-8
+            /// strings have their code points indexed, so finding a
+            /// substring doesn't need to walk the string from the start.
+            /// Like counting, this doesn't check the encoding.
+            std::optional<basic_view> index_substr(
+                    [[maybe_unused]] std::size_t const s,
+                    [[maybe_unused]] std::size_t const e) const {
+#if defined(F5_CORD_CODE_POINT_INDEX)
+                if constexpr (std::is_same_v<C, char>) {
+                    auto const index = detail::code_point_index(
+                            owner, buffer.data(), buffer.size());
+                    if (not index) return {};
+                    auto const first = index->position(buffer.data());
+                    auto const last = buffer.data() + buffer.size();
+                    auto const at = [&](std::size_t const n) {
+                        if (n >= index->code_points() - first) return last;
+                        return std::min(index->at(first + n), last);
+                    };
+                    return basic_view{buffer_type{at(s), at(e)}, owner};
+                }
+#endif
+                return {};
             }
 
+          public:
+
 
             /// ## Comparisons
 
@@ -277,17 +418,108 @@ namespace f5 {
                 return buffer > r.buffer;
             }
 
-            /// Useful checks for parts of a string
+            /// Useful checks for parts of a string. Only the code units at
+            /// the start or end of the string are looked at.
             bool starts_with(basic_view str) const {
                 return basic_view{buffer.slice(0, str.buffer.size())} == str;
             }
             bool ends_with(basic_view str) const {
                 if (str.code_units() > code_units()) {
                     return false;
-                } else if (str.code_units() == code_units()) {
-                    return *this == str;
                 } else {
-                    return substr(code_points() - str.code_points()) == str;
+                    return basic_view{buffer.slice(
+                                   code_units() - str.code_units())}
+                            == str;
+                }
+            }
+
+
+            /// ## Searching
+
+            /// Searches return an iterator to the start of the match, or
+            /// `end()` if there isn't one. The iterator has the view's
+            /// control block, so `basic_view{found, end()}` still shares
+            /// the allocation. The `_offset` versions return the position
+            /// in code units instead, or `npos`. Searching works on the
+            /// code units, so like counting the encoding isn't checked.
+            const_iterator find(basic_view str) const {
+                return iterator_at(find_offset(str));
+            }
+            const_iterator find(utf32 const cp) const {
+                return iterator_at(find_offset(cp));
+            }
+            std::size_t find_offset(basic_view str) const noexcept {
+                return detail::find_units(
+                        buffer.data(), buffer.size(), str.buffer.data(),
+                        str.buffer.size());
+            }
+            std::size_t find_offset(utf32 const cp) const {
+                auto const [length, units] =
+                        detail::encode_units<C, encoding_error_type>(cp);
+                return detail::find_units(
+                        buffer.data(), buffer.size(), units.data(), length);
+            }
+
+            /// Find the last match. The string is searched backwards from
+            /// the end, so only the code units after the match are looked
+            /// at.
+            const_iterator rfind(basic_view str) const {
+                return iterator_at(rfind_offset(str));
+            }
+            const_iterator rfind(utf32 const cp) const {
+                return iterator_at(rfind_offset(cp));
+            }
+            std::size_t rfind_offset(basic_view str) const noexcept {
+                return detail::rfind_units(
+                        buffer.data(), buffer.size(), str.buffer.data(),
+                        str.buffer.size());
+            }
+            std::size_t rfind_offset(utf32 const cp) const {
+                auto const [length, units] =
+                        detail::encode_units<C, encoding_error_type>(cp);
+                return detail::rfind_units(
+                        buffer.data(), buffer.size(), units.data(), length);
+            }
+
+            /// Find the first code point that is any of the ones in `set`
+            const_iterator find_first_of(basic_view set) const {
+                return iterator_at(find_first_of_offset(set));
+            }
+            std::size_t find_first_of_offset(basic_view set) const noexcept {
+                return detail::code_point_set<C>{
+                        set.buffer.data(), set.buffer.size()}
+                        .find(buffer.data(), buffer.size());
+            }
+
+            /// Returns `true` if `str` is somewhere in the string
+            bool contains(basic_view str) const noexcept {
+                return find_offset(str) != npos;
+            }
+            bool contains(utf32 const cp) const {
+                return find_offset(cp) != npos;
+            }
+
+            /// The number of times `str` appears without the matches
+            /// overlapping. An empty string is never counted.
+            std::size_t count(basic_view str) const noexcept {
+                return detail::count_units(
+                        buffer.data(), buffer.size(), str.buffer.data(),
+                        str.buffer.size());
+            }
+            std::size_t count(utf32 const cp) const {
+                auto const [length, units] =
+                        detail::encode_units<C, encoding_error_type>(cp);
+                return detail::count_units(
+                        buffer.data(), buffer.size(), units.data(), length);
+            }
+
+          private:
+            const_iterator iterator_at(std::size_t const offset) const {
+                if (offset == npos) {
+                    return end();
+                } else {
+                    return IM::template make_iterator<
+                            buffer_type, control_type>(buffer, offset, owner);
                 }
             }
         };
@@ -296,6 +528,13 @@ namespace f5 {
         using u8view = basic_view<char>;
         using u16view = basic_view<char16_t>;
         using u32view = basic_view<char32_t>;
+        /// A view whose control blocks are not atomically counted. See
+        /// `u8string_local`.
+        using u8view_local = basic_view<
+                char,
+                std::range_error,
+                iterators<char, std::range_error>,
+                plain_count>;
 
 
         /// ADL `std::size`and `std::data`  implementations
@@ -322,6 +561,7 @@ namespace f5 {
     using u8view = cord::u8view;
     using u16view = cord::u16view;
     using u32view = cord::u32view;
+    using u8view_local = cord::u8view_local;
 
 
 }
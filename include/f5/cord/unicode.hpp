@@ -9,7 +9,14 @@
 #pragma once
 
 
+#include <f5/cord/unicode-count.hpp>
 #include <f5/cord/unicode-encodings.hpp>
+#include <f5/cord/unicode-hash.hpp>
 #include <f5/cord/unicode-iterators.hpp>
+#include <f5/cord/unicode-retention.hpp>
 #include <f5/cord/unicode-view.hpp>
+#include <f5/cord/unicode-split.hpp>
+#include <f5/cord/unicode-stream.hpp>
 #include <f5/cord/unicode-string.hpp>
+#include <f5/cord/unicode-transcode.hpp>
+#include <f5/cord/unicode-validate.hpp>
@@ -10,6 +10,9 @@
 
 
 #include <f5/cord/lstring.hpp>
+#include <f5/stats.hpp>
+
+#include <type_traits>
 
 
 namespace f5 {
@@ -25,5 +28,15 @@ namespace f5 {
     template<>
     constexpr inline void raise<void>(f5::cord::lstring) {}
 
+    /// Raise an error for an invalid encoding. Those that are thrown are
+    /// counted in the statistics.
+    template<typename E>
+    constexpr inline void raise_encoding(f5::cord::lstring error) {
+        if constexpr (not std::is_void_v<E>) {
+            stats::record(stats::counter::encoding_errors);
+        }
+        raise<E>(error);
+    }
+
 
 }
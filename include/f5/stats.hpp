@@ -0,0 +1,211 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+
+namespace f5 {
+
+
+    /// ## Statistics
+    /**
+        Counters for what the strings cost at run time. They are only kept
+        when `F5_CORD_STATS` is defined, otherwise `record` does nothing and
+        `read` always returns zeros.
+
+        Each thread counts into its own slot, so recording is a load and a
+        store with no contention. `read` adds up the slots of all of the
+        threads. A slot outlives its thread and is reused by a later one,
+        so the counts from threads that have finished are kept.
+     */
+    namespace stats {
+
+
+        enum class counter : std::size_t {
+            /// Control blocks made, and released when their count reached
+            /// zero
+            control_blocks_created,
+            control_blocks_destroyed,
+            /// Bytes in the allocations made for control blocks, and in
+            /// those released
+            bytes_allocated,
+            bytes_released,
+            /// Calls that changed an ownership count
+            increments,
+            decrements,
+            /// Strings copied because the view they were made from had no
+            /// control block
+            transitional_copies,
+            /// Strings copied by `shrink_to_fit` to get a NUL terminator
+            shrink_to_fit_copies,
+            /// Strings made by `operator+`
+            concatenations,
+            /// Invalid encodings found and raised as errors
+            encoding_errors,
+            /// Strings copied out of an allocation they used little of,
+            /// by the compaction policy or `compact`
+            compactions
+        };
+        inline constexpr std::size_t counters = 11u;
+        inline constexpr char const *names[counters] = {
+                "control_blocks_created",
+                "control_blocks_destroyed",
+                "bytes_allocated",
+                "bytes_released",
+                "increments",
+                "decrements",
+                "transitional_copies",
+                "shrink_to_fit_copies",
+                "concatenations",
+                "encoding_errors",
+                "compactions"};
+
+#if defined(F5_CORD_STATS)
+        inline constexpr bool enabled = true;
+#else
+        inline constexpr bool enabled = false;
+#endif
+
+
+        /// The counts at one point in time
+        struct snapshot {
+            std::array<std::uint64_t, counters> values = {};
+
+            std::uint64_t operator[](counter const c) const noexcept {
+                return values[static_cast<std::size_t>(c)];
+            }
+
+            /// Control blocks and bytes that are still in use
+            std::uint64_t control_blocks() const noexcept {
+                return (*this)[counter::control_blocks_created]
+                        - (*this)[counter::control_blocks_destroyed];
+            }
+            std::uint64_t bytes_held() const noexcept {
+                return (*this)[counter::bytes_allocated]
+                        - (*this)[counter::bytes_released];
+            }
+
+            /// What has been counted since an earlier snapshot
+            snapshot operator-(snapshot const &earlier) const noexcept {
+                snapshot s;
+                for (std::size_t c{}; c < counters; ++c) {
+                    s.values[c] = values[c] - earlier.values[c];
+                }
+                return s;
+            }
+
+            /// Call `f(name, value)` for each counter, for passing on to a
+            /// metrics system
+            template<typename F>
+            void each(F &&f) const {
+                for (std::size_t c{}; c < counters; ++c) f(names[c], values[c]);
+            }
+        };
+
+
+        namespace detail {
+
+
+            struct slot {
+                std::array<std::atomic<std::uint64_t>, counters> values = {};
+                std::atomic<bool> in_use{true};
+                slot *next = nullptr;
+            };
+
+            /// Every slot that has been made. They are never freed.
+            inline std::atomic<slot *> slots{nullptr};
+            /// Used, with atomic additions, by threads that are exiting or
+            /// couldn't get a slot of their own
+            inline slot shared;
+
+            inline thread_local slot *current = nullptr;
+            inline thread_local bool exited = false;
+
+            /// Gives the thread's slot back when the thread exits
+            struct slot_owner {
+                slot *owned;
+                ~slot_owner() {
+                    exited = true;
+                    current = nullptr;
+                    owned->in_use.store(false, std::memory_order_release);
+                }
+            };
+
+            inline slot *claim() noexcept {
+                if (exited) return &shared;
+                auto s = slots.load(std::memory_order_acquire);
+                for (; s; s = s->next) {
+                    bool idle = false;
+                    if (s->in_use.compare_exchange_strong(idle, true)) break;
+                }
+                if (not s) {
+                    s = new (std::nothrow) slot;
+                    if (not s) return &shared;
+                    s->next = slots.load(std::memory_order_relaxed);
+                    while (not slots.compare_exchange_weak(
+                            s->next, s, std::memory_order_release,
+                            std::memory_order_relaxed))
+                        ;
+                }
+                thread_local slot_owner owner{s};
+                return current = s;
+            }
+
+
+        }
+
+
+        /// Add `n` to a counter
+        inline void record(
+                [[maybe_unused]] counter const c,
+                [[maybe_unused]] std::uint64_t const n = 1u) noexcept {
+#if defined(F5_CORD_STATS)
+            auto const s = detail::current ? detail::current : detail::claim();
+            auto &v = s->values[static_cast<std::size_t>(c)];
+            if (s == &detail::shared) {
+                v.fetch_add(n, std::memory_order_relaxed);
+            } else {
+                v.store(v.load(std::memory_order_relaxed) + n,
+                        std::memory_order_relaxed);
+            }
+#endif
+        }
+
+
+        /// The totals across all threads. Counting carries on while this
+        /// runs, so counts that go together, like blocks created and
+        /// destroyed, may not be from exactly the same moment.
+        inline snapshot read() noexcept {
+            snapshot totals;
+#if defined(F5_CORD_STATS)
+            auto const add = [&](detail::slot const &s) {
+                for (std::size_t c{}; c < counters; ++c) {
+                    totals.values[c] +=
+                            s.values[c].load(std::memory_order_relaxed);
+                }
+            };
+            add(detail::shared);
+            for (auto s = detail::slots.load(std::memory_order_acquire); s;
+                 s = s->next) {
+                add(*s);
+            }
+#endif
+            return totals;
+        }
+
+
+    }
+
+
+}
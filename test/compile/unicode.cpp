@@ -6,6 +6,7 @@
  */
 
 
+#include <f5/cord/literals.hpp>
 #include <f5/cord/tstring.hpp>
 #include <f5/cord/unicode.hpp>
 using namespace f5::literals;
@@ -63,3 +64,58 @@ static_assert(not f5::cord::is_surrogate(0xfffd), "Replacement char");
 static_assert(f5::cord::u16decode(0xd834, 0xdd1e) == 0x1d11e, "Treble clef");
 static_assert(
         f5::cord::u16decode<void>(0xdd1e, 0xd834) == 0xfffd, "Substituted");
+
+
+// Literals transcoded at compile time
+static_assert(u""_u8.size() == 0u, "Empty literal");
+static_assert(u"Hello"_u8 == "Hello", "ASCII is unchanged");
+static_assert(u"\x2713"_u8 == "\xE2\x9C\x93", "Check mark");
+static_assert(
+        u"\xD834\xDD1E"_u8 == "\xF0\x9D\x84\x9E",
+        "Treble clef from a surrogate pair");
+static_assert(U"\x1D11E"_u8 == "\xF0\x9D\x84\x9E", "Treble clef from UTF-32");
+static_assert(U"\x1D11E"_u8.c_str()[4] == 0, "Literals are NUL terminated");
+
+
+// Short strings are stored inline
+static_assert(
+        f5::u8string::inline_capacity == 2 * sizeof(void *) - 1,
+        "Inline capacity fills the space of two pointers");
+static_assert(
+        sizeof(f5::u8string) == 4 * sizeof(void *),
+        "Inline strings need no more than another pointer's worth of space");
+
+
+// Strings with a plain reference count
+static_assert(
+        sizeof(f5::u8string_local) == sizeof(f5::u8string),
+        "The counting policy doesn't change the string size");
+static_assert(
+        std::is_constructible_v<f5::u8string_local, f5::u8string const &>,
+        "Strings can be converted between counting policies");
+static_assert(
+        not std::is_convertible_v<f5::u8string const &, f5::u8string_local>,
+        "But only explicitly");
+static_assert(
+        not std::is_convertible_v<f5::u8string_local const &, f5::u8string>,
+        "In both directions");
+
+
+// The code point iterators can move backwards
+static_assert(
+        std::is_same_v<
+                std::iterator_traits<
+                        f5::u8view::const_iterator>::iterator_category,
+                std::bidirectional_iterator_tag>,
+        "UTF-8 iteration is bidirectional");
+static_assert(
+        std::is_same_v<
+                std::iterator_traits<
+                        f5::u16view::const_iterator>::iterator_category,
+                std::bidirectional_iterator_tag>,
+        "UTF-16 iteration is bidirectional");
+static_assert(
+        std::is_same_v<
+                f5::u8string::const_reverse_iterator,
+                std::reverse_iterator<f5::u8string::const_iterator>>,
+        "Strings can be iterated in reverse");
@@ -6,9 +6,9 @@
  */
 
 
+#include <f5/cord/map-file.hpp>
 #include <f5/cord/unicode.hpp>
 
-#include <fstream>
 #include <iostream>
 
 
@@ -19,16 +19,9 @@ int main(int argc, char const *argv[]) {
                   << argv[0] << " u8filename" << std::endl;
         return 1;
     }
-    /// Load the data from the file
-    std::ifstream input{argv[1]};
-    std::vector<char> bytes;
-    while (input) {
-        char c;
-        input.get(c);
-        bytes.push_back(c);
-    }
     try {
-        f5::u8string string{std::string{bytes.data(), bytes.size()}};
+        /// Map the file rather than copying it into memory
+        auto const string = f5::cord::map_file(argv[1]);
         /// Display meta-data about the file content
         std::cout << "Bytes: " << string.memory().size() << std::endl;
         std::cout << "Code points: " << string.code_points() << std::endl;
@@ -0,0 +1 @@
+#include <f5/control-pool.hpp>
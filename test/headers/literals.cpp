@@ -0,0 +1 @@
+#include <f5/cord/literals.hpp>
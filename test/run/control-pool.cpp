@@ -0,0 +1,96 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/control-pool.hpp>
+#include <f5/cord/unicode-string.hpp>
+
+#include <set>
+#include <thread>
+#include <vector>
+
+
+namespace {
+    f5::u8string make(char const *const s) {
+        return f5::u8string{std::string{s}};
+    }
+}
+
+
+int main() {
+    static_assert(f5::control_pool::size_class(1u) == 0u);
+    static_assert(f5::control_pool::size_class(64u) == 0u);
+    static_assert(f5::control_pool::size_class(65u) == 1u);
+    static_assert(f5::control_pool::size_class(2048u) == 5u);
+    static_assert(
+            f5::control_pool::size_class(2049u) == f5::control_pool::classes);
+
+    f5::control_pool::install();
+    char const *const text = "A string that is too long to be stored inline";
+
+    /// Freed blocks are reused by the same thread
+    {
+        void const *address = nullptr;
+        {
+            auto const s = make(text);
+            assert(s == text);
+            assert(not s.is_inline());
+            address = s.control_block();
+        }
+        auto const s = make(text);
+        assert(s.control_block() == address);
+    }
+
+    /// Blocks freed on another thread join that thread's free list
+    {
+        auto s = make(text);
+        void const *const address = s.control_block();
+        std::thread{[&]() {
+            auto const moved = std::move(s);
+            assert(moved == text);
+        }}.join();
+        /// That thread has now exited and its free list given back to
+        /// the global one, from which this thread can take it
+        std::set<void const *> seen;
+        std::vector<f5::u8string> strings;
+        for (std::size_t n{}; n < f5::control_pool::thread_limit; ++n) {
+            strings.push_back(make(text));
+            seen.insert(strings.back().control_block());
+        }
+        assert(seen.count(address));
+    }
+
+    /// Large numbers of blocks move between threads through the global list
+    {
+        std::vector<f5::u8string> strings;
+        for (std::size_t n{}; n < 4u * f5::control_pool::thread_limit; ++n) {
+            strings.push_back(make(text));
+        }
+        std::set<void const *> made;
+        for (auto const &s : strings) made.insert(s.control_block());
+        std::thread{[&]() { strings.clear(); }}.join();
+        std::size_t found{};
+        for (std::size_t n{}; n < f5::control_pool::thread_limit; ++n) {
+            strings.push_back(make(text));
+            if (made.count(strings.back().control_block())) ++found;
+        }
+        assert(found == f5::control_pool::thread_limit);
+    }
+
+    /// Strings made with the pool outlive it being uninstalled, and larger
+    /// blocks aren't pooled
+    auto const pooled = make(text);
+    f5::control_pool::uninstall();
+    std::string const big(4096u, 'x');
+    auto const large = f5::u8string{big};
+    assert(large.code_units() == 4096u);
+    assert(pooled == text);
+
+    return 0;
+}
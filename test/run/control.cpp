@@ -0,0 +1,64 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/control.hpp>
+
+#include <cstring>
+#include <string>
+
+
+namespace {
+    std::size_t destructed{};
+    struct counted {
+        std::string s;
+        ~counted() { ++destructed; }
+    };
+}
+
+
+int main() {
+    {
+        auto made = f5::control<std::size_t>::make(counted{"Hello"}, 5u);
+        destructed = 0u;
+        auto const c = made.first.release();
+        assert(c->user_data == 5u);
+        assert(made.second->s == "Hello");
+        assert(f5::control<std::size_t>::owners(c) == 1u);
+        f5::control<std::size_t>::increment(c);
+        assert(f5::control<std::size_t>::owners(c) == 2u);
+        f5::control<std::size_t>::decrement(c);
+        assert(destructed == 0u);
+        f5::control<std::size_t>::decrement(c);
+        assert(destructed == 1u);
+    }
+    {
+        auto made = f5::control<void>::make(counted{"Hello"});
+        destructed = 0u;
+        made.first.reset();
+        assert(destructed == 1u);
+    }
+    {
+        auto made = f5::control<std::size_t>::make_array<char>(12u, 11u);
+        assert(made.first->user_data == 11u);
+        auto const start = reinterpret_cast<char const *>(made.first.get());
+        assert(made.second >= start + sizeof(f5::control<std::size_t>));
+        std::memcpy(made.second, "Hello world", 12u);
+        auto const c = f5::control<std::size_t>::increment(made.first.get());
+        made.first.reset();
+        assert(std::string{made.second} == "Hello world");
+        f5::control<std::size_t>::decrement(c);
+    }
+    {
+        auto made = f5::control<std::size_t>::make_array<char32_t>(3u, 3u);
+        assert(reinterpret_cast<std::uintptr_t>(made.second) % alignof(char32_t)
+               == 0u);
+    }
+    return 0;
+}
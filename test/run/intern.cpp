@@ -0,0 +1,135 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/intern.hpp>
+
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace {
+    f5::u8view view(std::string const &s) {
+        return f5::u8view{s.data(), s.size()};
+    }
+    std::string long_key(std::size_t const n) {
+        return "A key that is long enough not to be inline " + std::to_string(n);
+    }
+}
+
+
+int main() {
+    f5::cord::intern_pool pool;
+    assert(pool.size() == 0u);
+    assert(not pool.find("content-type"));
+
+    /// Ids are dense and the same for equal strings
+    auto const ct = pool.id("content-type");
+    auto const cl = pool.id("content-length");
+    assert(ct == 0u);
+    assert(cl == 1u);
+    assert(pool.id(view(std::string{"content-type"})) == ct);
+    assert(pool.find("content-length") == cl);
+    assert(pool.string(ct) == "content-type");
+    assert(pool.size() == 2u);
+
+    /// Interned strings share the pool's control block, even short ones
+    auto const ct_held = pool.intern("content-type");
+    assert(ct_held.is_shared());
+    assert(not ct_held.is_inline());
+    assert(ct_held.shares_allocation_with(pool.string(ct)));
+    auto const key = long_key(1);
+    auto const a = pool.intern(view(key));
+    auto const b = pool.intern(view(key));
+    assert(a == key);
+    assert(a.is_shared());
+    assert(a.shares_allocation_with(b));
+    assert(a.shares_allocation_with(pool.string(*pool.find(a))));
+    /// The pool copies rather than sharing the caller's allocation
+    f5::u8string const outside{key};
+    auto const c = pool.intern(outside);
+    assert(c.shares_allocation_with(a));
+    assert(not c.shares_allocation_with(outside));
+
+    /// Many ids, crossing several segments
+    std::vector<f5::cord::intern_pool::id_type> ids;
+    for (std::size_t n{}; n < 5000u; ++n) {
+        ids.push_back(pool.id(view(std::to_string(n))));
+    }
+    for (std::size_t n{}; n < 5000u; ++n) {
+        assert(ids[n] == n + 3u);
+        assert(pool.string(ids[n]) == std::to_string(n));
+    }
+
+    /// Sweeping removes the strings only the pool holds, including short
+    /// ones that were only given ids
+    assert(pool.sweep() == 5001u);
+    assert(pool.size() == 2u);
+    assert(pool.find("content-type") == ct);
+    assert(pool.find(view(key)).has_value());
+    assert(not pool.find("content-length"));
+    assert(not pool.find("42"));
+    bool host_held{};
+    {
+        auto const held = pool.intern(view(long_key(2)));
+        auto const short_held = pool.intern("accept");
+        auto const unheld = pool.id(view(long_key(3)));
+        auto const short_unheld = pool.id("host");
+        /// A short string made from a view is copied inline, so doesn't
+        /// hold the entry
+        f5::u8string const copied{f5::u8view{pool.string(short_unheld)}};
+        host_held = not copied.is_inline();
+        assert(pool.sweep() == (host_held ? 1u : 2u));
+        assert(copied == "host");
+        assert(pool.find(view(long_key(2))).has_value());
+        assert(pool.find("accept").has_value());
+        assert(not pool.find(view(long_key(3))));
+        assert(pool.find("host").has_value() == host_held);
+        /// Swept ids are used again
+        auto const reused = pool.id(view(long_key(5)));
+        assert(reused == unheld || reused == short_unheld);
+    }
+    assert(pool.sweep() == (host_held ? 4u : 3u));
+    assert(not pool.find(view(long_key(2))));
+    assert(not pool.find("accept"));
+    assert(pool.size() == 2u);
+    assert(pool.id("content-length") < 5003u);
+
+    /// Threads interning the same strings get the same ids
+    f5::cord::intern_pool shared;
+    std::vector<std::vector<f5::cord::intern_pool::id_type>> found(4u);
+    std::vector<std::thread> threads;
+    for (std::size_t t{}; t < found.size(); ++t) {
+        threads.emplace_back([&shared, &found, t]() {
+            for (std::size_t n{}; n < 3000u; ++n) {
+                auto const k = (n * (t + 1u)) % 1000u;
+                auto const s = k % 2u ? long_key(k) : std::to_string(k);
+                found[t].push_back(shared.id(view(s)));
+            }
+        });
+    }
+    for (auto &t : threads) t.join();
+    assert(shared.size() == 1000u);
+    std::set<f5::cord::intern_pool::id_type> distinct;
+    for (std::size_t t{}; t < found.size(); ++t) {
+        for (std::size_t n{}; n < 3000u; ++n) {
+            auto const k = (n * (t + 1u)) % 1000u;
+            auto const id = found[t][n];
+            assert(id < 1000u);
+            distinct.insert(id);
+            assert(shared.string(id)
+                   == (k % 2u ? long_key(k) : std::to_string(k)));
+        }
+    }
+    assert(distinct.size() == 1000u);
+
+    return 0;
+}
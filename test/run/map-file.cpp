@@ -0,0 +1,112 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/map-file.hpp>
+#include <f5/cord/unicode-retention.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+
+namespace {
+    std::filesystem::path write(std::string const &content) {
+        auto const path = std::filesystem::temp_directory_path()
+                / ("f5-cord-map-file-" + std::to_string(::getpid()));
+        std::ofstream{path, std::ios::binary}.write(
+                content.data(), content.size());
+        return path;
+    }
+    f5::u8view view(std::string const &s) {
+        return f5::u8view{s.data(), s.size()};
+    }
+}
+
+
+int main() {
+    {
+        std::string const content =
+                "A file long enough not to be stored inline \xE2\x9C\x93\n";
+        auto const path = write(content);
+        auto const mapped = f5::cord::map_file(path);
+        std::filesystem::remove(path);
+        assert(mapped == view(content));
+        assert(mapped.is_shared());
+        assert(mapped.code_points() == content.size() - 2u);
+        /// Substrings and views share the mapping
+        auto const tail = mapped.substr(2);
+        assert(tail.shares_allocation_with(mapped));
+        f5::u8view const tail_view = tail;
+        assert(f5::u8string{tail_view}.shares_allocation_with(mapped));
+        /// The rest of the page is zero filled so it is already C safe
+        auto copy = mapped;
+        assert(copy.shrink_to_fit() == mapped.data());
+        assert(std::strlen(copy.shrink_to_fit()) == content.size());
+        /// Checked construction shares the mapping too
+        f5::u8string const checked{f5::cord::checked, mapped};
+        assert(checked.shares_allocation_with(mapped));
+    }
+    {
+        /// A file exactly filling its pages has a page of zeros after it
+        /// to give it a NUL
+        std::string const content(::sysconf(_SC_PAGESIZE), 'x');
+        auto const path = write(content);
+        auto mapped = f5::cord::map_file(
+                path, {f5::cord::map_access::random, true, true});
+        std::filesystem::remove(path);
+        assert(mapped.code_units() == content.size());
+        auto const data = mapped.data();
+        assert(mapped.shrink_to_fit() == data);
+        assert(std::strlen(mapped.shrink_to_fit()) == content.size());
+    }
+    {
+        /// Substrings of a large mapping report what it retains, whether
+        /// or not the file ends on a page boundary, and can be compacted
+        for (std::size_t const size :
+             {std::size_t{1u} << 20u, (std::size_t{1u} << 20u) + 1u}) {
+            std::string const content(size, 'y');
+            auto const path = write(content);
+            std::vector<f5::u8string> keys;
+            {
+                auto const mapped = f5::cord::map_file(path);
+                keys.emplace_back(f5::u8view{mapped}.substr_pos(0u, 100u));
+            }
+            std::filesystem::remove(path);
+            auto const r = f5::cord::retention(keys[0]);
+            assert(r.referenced == 100u);
+            assert(r.retained == size);
+            assert(f5::cord::compact(keys) == 1u);
+            assert(f5::cord::retention(keys[0]).unused() == 0u);
+            assert(keys[0] == view(std::string(100u, 'y')));
+        }
+    }
+    {
+        auto const path = write("");
+        assert(f5::cord::map_file(path).empty());
+        std::filesystem::remove(path);
+    }
+    {
+        auto const path = write("short");
+        assert(f5::cord::map_file(path) == "short");
+        assert(f5::cord::map_file(path).is_inline());
+        std::filesystem::remove(path);
+    }
+    try {
+        f5::cord::map_file("/this/file/does/not/exist");
+        assert(false);
+    } catch (std::system_error &e) {
+        assert(e.code() == std::errc::no_such_file_or_directory);
+    }
+    return 0;
+}
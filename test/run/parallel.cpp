@@ -0,0 +1,187 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/parallel.hpp>
+#include <f5/cord/unicode.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+    template<typename S>
+    S repeat(S const &s, std::size_t const times) {
+        S r;
+        for (std::size_t t{}; t < times; ++t) r += s;
+        return r;
+    }
+
+    /// The parts cover the view in order
+    template<typename V>
+    void covers(std::vector<V> const &parts, V const v) {
+        auto next = v.data();
+        for (auto const &p : parts) {
+            assert(not p.empty());
+            assert(p.data() == next);
+            next += p.code_units();
+        }
+        assert(next == v.data() + v.code_units());
+    }
+}
+
+
+int main() {
+    using f5::cord::partition;
+    using f5::cord::partition_boundary;
+    namespace parallel = f5::cord::parallel;
+
+    /// Parts start on code points and keep the string's allocation
+    f5::u8string const text{repeat(
+            std::string{"some text \xF0\x9F\x98\x83 caf\xC3\xA9\n"}, 200u)};
+    for (std::size_t n : {1u, 2u, 3u, 7u, 64u, 5000u}) {
+        auto const parts = partition(f5::u8view{text}, n);
+        assert(parts.size() <= n);
+        covers(parts, f5::u8view{text});
+        for (auto const &p : parts) {
+            assert(p.shares_allocation_with(text));
+            assert(f5::cord::valid_length(
+                           static_cast<f5::cord::const_u8buffer>(p))
+                   == p.code_units());
+        }
+        for (auto const &p :
+             partition(f5::u8view{text}, n, partition_boundary::line)) {
+            assert(p.ends_with("\n"));
+        }
+    }
+    assert(partition(f5::u8view{}, 4u).empty());
+    assert(partition(f5::u8view{"abc"}, 0u).size() == 1u);
+    assert(partition(f5::u8view{"no line ends"}, 4u, partition_boundary::line)
+                   .size()
+           == 1u);
+
+    std::u16string const u16{
+            repeat(std::u16string{u"ab\xD83D\xDE03"}, 100u)};
+    f5::u16view const v16{u16.data(), u16.size()};
+    for (std::size_t n : {2u, 3u, 9u, 400u}) {
+        auto const parts = partition(v16, n);
+        covers(parts, v16);
+        for (auto const &p : parts) {
+            assert((p.data()[0] & 0xfc00) != 0xdc00);
+        }
+    }
+
+    /// Force several threads and lots of small parts
+    parallel::options const options{3u, 1u, 5u};
+    f5::u8view const v{text};
+    assert(parallel::code_points(v, options) == v.code_points());
+    assert(parallel::valid_length(v, options) == v.code_units());
+    assert(parallel::code_points(v16, options) == v16.code_points());
+    assert(parallel::code_points(v) == v.code_points());
+
+    /// The first error is found wherever it is
+    std::string bad{text};
+    bad[bad.size() / 2u] = '\xFF';
+    bad[bad.size() - 10u] = '\xFF';
+    f5::u8view const vbad{bad.data(), bad.size()};
+    assert(parallel::valid_length(vbad, options)
+           == f5::cord::valid_length(
+                   static_cast<f5::cord::const_u8buffer>(vbad)));
+
+    /// Transcoding
+    auto const wide = parallel::transcode<f5::cord::utf16>(v, options);
+    assert(wide == f5::cord::transcode<f5::cord::utf16>(v));
+    assert(parallel::transcode<f5::cord::utf8>(f5::u16view{wide}, options)
+           == text);
+    assert(parallel::transcode<f5::cord::utf8>(v16, options)
+           == f5::cord::transcode<f5::cord::utf8>(v16));
+    assert(parallel::transcode<f5::cord::utf32>(v, options)
+           == f5::cord::transcode<f5::cord::utf32>(v));
+    assert((parallel::transcode<f5::cord::utf16, void>(vbad, options)
+            == f5::cord::transcode<f5::cord::utf16, void>(vbad)));
+    bool raised = false;
+    try {
+        parallel::transcode<f5::cord::utf16>(vbad, options);
+    } catch (std::range_error const &) { raised = true; }
+    assert(raised);
+
+    /// Matches are found across the part boundaries, without overlapping
+    auto const aaa = repeat(std::string{"a"}, 1001u);
+    f5::u8view const va{aaa.data(), aaa.size()};
+    for (std::size_t m : {1u, 2u, 3u, 7u}) {
+        auto const needle = va.substr_pos(0u, m);
+        auto const found = parallel::find_all(va, needle, options);
+        assert(found.size() == va.count(needle));
+        for (std::size_t i{}; i < found.size(); ++i) {
+            assert(found[i] == i * m);
+        }
+    }
+    /// Needles that overlap themselves, where the parts start out of step
+    /// with the matches kept
+    auto const abab = repeat(std::string{"ab"}, 500u) + "a"
+            + repeat(std::string{"aab"}, 300u);
+    f5::u8view const vab{abab.data(), abab.size()};
+    for (auto const needle : {"aba", "abab", "aab", "aaba", "ba"}) {
+        f5::u8view const n{needle, std::strlen(needle)};
+        std::vector<std::size_t> expected;
+        for (auto at = abab.find(needle); at != std::string::npos;
+             at = abab.find(needle, at + n.code_units())) {
+            expected.push_back(at);
+        }
+        for (std::size_t parts : {2u, 7u, 64u}) {
+            parallel::options const split{3u, 1u, parts};
+            assert(parallel::find_all(vab, n, split) == expected);
+        }
+    }
+    auto const smiles = parallel::find_all(
+            v, f5::u8view{"\xF0\x9F\x98\x83 caf"}, options);
+    assert(smiles.size() == 200u);
+    assert(smiles[1] == 10u + 21u);
+    assert(parallel::find_all(v, f5::u8view{}, options).empty());
+    assert(parallel::find_all(v, f5::u8view{"#"}, options).empty());
+
+    /// Exceptions are passed back to the caller
+    raised = false;
+    try {
+        f5::cord::detail::parallel_for(100u, 4u, [](std::size_t const n) {
+            if (n == 50u) throw std::runtime_error{"Task failed"};
+        });
+    } catch (std::runtime_error const &) { raised = true; }
+    assert(raised);
+
+#if defined(__linux__) && not defined(__SANITIZE_ADDRESS__) \
+        && not defined(__SANITIZE_THREAD__)
+    /// Threads that can't be started are left out, rather than ending the
+    /// program. Capping the address space leaves no room for their stacks.
+    {
+        std::size_t pages{};
+        std::ifstream{"/proc/self/statm"} >> pages;
+        ::rlimit original;
+        ::getrlimit(RLIMIT_AS, &original);
+        auto capped = original;
+        capped.rlim_cur = pages * ::sysconf(_SC_PAGESIZE) + (16u << 20u);
+        ::setrlimit(RLIMIT_AS, &capped);
+        std::atomic<std::size_t> ran{};
+        f5::cord::detail::parallel_for(
+                1000u, 256u, [&](std::size_t) { ++ran; });
+        ::setrlimit(RLIMIT_AS, &original);
+        assert(ran == 1000u);
+    }
+#endif
+
+    return 0;
+}
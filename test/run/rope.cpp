@@ -0,0 +1,146 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/rope.hpp>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+
+namespace {
+    f5::u8view view(std::string const &s) {
+        return f5::u8view{s.data(), s.size()};
+    }
+}
+
+
+int main() {
+    f5::cord::rope const e;
+    assert(e.empty());
+    assert(e.bytes() == 0u);
+    assert(e == "");
+    assert(e.flatten().empty());
+    assert(e.begin() == e.end());
+    assert(e.chunks().begin() == e.chunks().end());
+
+    /// A single leaf shares its string
+    f5::u8string const long_text{std::string{
+            "A string that is too long to be stored inline \xE2\x9C\x93"}};
+    f5::cord::rope const one{long_text};
+    assert(one.bytes() == long_text.code_units());
+    assert(one.code_points() == long_text.code_points());
+    assert(one.height() == 0u);
+    assert(one.flatten().shares_allocation_with(long_text));
+    assert(one == long_text);
+
+    /// Short neighbours are merged
+    f5::cord::rope const hw = f5::cord::rope{"Hello"} + " " + "world";
+    assert(hw == "Hello world");
+    assert(hw.height() == 0u);
+    /// Longer ones are not, and the leaves share the strings
+    auto const twice = one + long_text;
+    assert(twice.height() == 1u);
+    for (auto const chunk : twice.chunks()) {
+        assert(long_text.shares_allocation_with(chunk));
+    }
+    assert(twice.flatten() == std::string{long_text} + std::string{long_text});
+
+    /// Build a large rope from many fragments and check it against a
+    /// `std::string` built the same way
+    std::vector<std::string> const fragments{
+            "The quick brown fox jumps over the lazy dog. ",
+            "\xC3\xA6\xC3\xB8\xC3\xA5 ",
+            "\xE2\x9C\x93 \xF0\x9F\x98\x83 ",
+            "Pack my box with five dozen liquor jugs, ",
+            "x"};
+    std::string expected;
+    std::vector<char32_t> code_points;
+    f5::cord::rope built;
+    for (std::size_t n{}; n < 5000u; ++n) {
+        auto const &f = fragments[n % fragments.size()];
+        expected += f;
+        for (auto const cp : view(f)) code_points.push_back(cp);
+        if (n % 2u) {
+            built += f5::u8string{f};
+        } else {
+            built = built + view(f);
+        }
+    }
+    assert(built == view(expected));
+    assert(built.bytes() == expected.size());
+    assert(built.code_points() == code_points.size());
+    assert(built.flatten() == expected);
+    assert(std::equal(
+            built.begin(), built.end(), code_points.begin(),
+            code_points.end()));
+    /// The tree is balanced
+    std::size_t leaves{};
+    for (auto const chunk : built.chunks()) {
+        assert(not chunk.empty());
+        ++leaves;
+    }
+    assert(built.height() <= 1.45 * std::log2(leaves) + 2);
+
+    /// Joining big ropes of different heights keeps them balanced
+    auto const joined = built + one + built.substr(1000u) + built;
+    auto const tail = built.substr(1000u).flatten();
+    assert(joined.flatten()
+           == expected + std::string{long_text} + std::string{tail}
+                   + expected);
+    assert(joined.height() <= built.height() + 2u);
+
+    /// Substrings by byte
+    for (std::size_t s = 0u; s < expected.size(); s += 997u) {
+        for (std::size_t length : {0u, 1u, 45u, 46u, 1000u, 20000u}) {
+            /// Only test those that fall on code point boundaries
+            auto const boundary = [&](std::size_t p) {
+                return p >= expected.size()
+                        || (static_cast<unsigned char>(expected[p]) & 0xc0)
+                        != 0x80;
+            };
+            if (not boundary(s) || not boundary(s + length)) continue;
+            auto const sub = built.substr_bytes(s, s + length);
+            assert(sub == view(expected.substr(s, length)));
+        }
+    }
+    assert(built.substr_bytes(expected.size()).empty());
+    assert(built.substr_bytes(10u, 5u).empty());
+
+    /// Substrings by code point
+    for (std::size_t s = 0u; s < code_points.size(); s += 1009u) {
+        for (std::size_t length : {0u, 1u, 2u, 50u, 3000u, 50000u}) {
+            auto const sub = built.substr_pos(s, s + length);
+            auto const e = std::min(s + length, code_points.size());
+            assert(sub.code_points() == e - s);
+            assert(std::equal(
+                    sub.begin(), sub.end(), code_points.begin() + s,
+                    code_points.begin() + e));
+        }
+        auto const rest = built.substr(s);
+        assert(rest.code_points() == code_points.size() - s);
+        assert(*rest.begin() == code_points[s]);
+    }
+    assert(built.substr(code_points.size()).empty());
+
+    /// Substrings share the leaves
+    auto const middle = twice.substr_bytes(10u, twice.bytes() - 10u);
+    for (auto const chunk : middle.chunks()) {
+        assert(long_text.shares_allocation_with(chunk));
+    }
+
+    /// Comparisons
+    assert(built == built.substr(0u));
+    assert(built != built.substr(1u));
+    assert(joined.substr_bytes(0u, built.bytes()) == built);
+    assert(hw != "Hello World");
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/unicode.hpp>
+#include <f5/stats.hpp>
+
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace {
+    using f5::stats::counter;
+
+    template<typename F>
+    f5::stats::snapshot counting(F f) {
+        auto const before = f5::stats::read();
+        f();
+        return f5::stats::read() - before;
+    }
+}
+
+
+int main() {
+    std::string const long_text(100u, 'x');
+
+    if constexpr (not f5::stats::enabled) {
+        f5::u8string const s{long_text};
+        auto const copy = s + s;
+        auto const totals = f5::stats::read();
+        for (auto const v : totals.values) assert(v == 0u);
+        return 0;
+    }
+
+    /// Control blocks and their memory
+    auto const made = counting([&]() {
+        f5::u8string const s{long_text};
+        assert(f5::stats::read().control_blocks() > 0u);
+        assert(f5::stats::read().bytes_held() >= 100u);
+    });
+    assert(made[counter::control_blocks_created] == 1u);
+    assert(made[counter::control_blocks_destroyed] == 1u);
+    assert(made[counter::bytes_allocated] >= 101u);
+    assert(made.bytes_held() == 0u);
+    assert(made.control_blocks() == 0u);
+
+    /// Short strings have no control block
+    auto const short_string = counting([]() { f5::u8string const s{"short"}; });
+    assert(short_string[counter::control_blocks_created] == 0u);
+
+    /// Copies change the count
+    f5::u8string const s{long_text};
+    auto const copies = counting([&]() {
+        auto const a = s;
+        auto const b = a;
+    });
+    assert(copies[counter::increments] == 2u);
+    assert(copies[counter::decrements] == 2u);
+    assert(copies[counter::control_blocks_created] == 0u);
+
+    /// Strings made from views of memory without a control block are
+    /// copied
+    auto const transitional = counting([&]() {
+        f5::u8view const v{long_text.data(), long_text.size()};
+        f5::u8string const from{v};
+        f5::u8string const shared{f5::u8view{s}};
+    });
+    assert(transitional[counter::transitional_copies] == 1u);
+
+    auto const shrink = counting([&]() {
+        f5::u8string const sub{f5::u8view{s}.substr(1u)};
+        auto copy = sub;
+        copy.shrink_to_fit();
+        copy.shrink_to_fit();
+    });
+    assert(shrink[counter::shrink_to_fit_copies] == 1u);
+
+    auto const compacted = counting([&]() {
+        std::vector<f5::u8string> keys{
+                f5::u8string{f5::u8view{s}.substr_pos(0u, 50u)}};
+        f5::cord::compact(keys);
+    });
+    assert(compacted[counter::compactions] == 1u);
+
+    auto const joined = counting([&]() { auto const j = s + s + s; });
+    assert(joined[counter::concatenations] == 2u);
+    assert(joined[counter::control_blocks_created] == 2u);
+
+    auto const errors = counting([]() {
+        try {
+            f5::u8string{f5::cord::checked, "\xFF"};
+        } catch (std::exception const &) {}
+        f5::cord::transcode<f5::cord::utf16, void>(f5::u8view{"\xFF"});
+    });
+    assert(errors[counter::encoding_errors] == 1u);
+
+    /// The counts from other threads are included, even after they exit
+    auto const threaded = counting([&]() {
+        std::thread t1{[&]() { f5::u8string const copy{long_text}; }};
+        t1.join();
+        std::thread t2{[&]() {
+            for (auto n{0}; n < 10; ++n) f5::u8string const copy{long_text};
+        }};
+        t2.join();
+    });
+    assert(threaded[counter::control_blocks_created] == 11u);
+    assert(threaded[counter::control_blocks_destroyed] == 11u);
+
+    /// All of the counters can be passed on by name
+    std::map<std::string, std::uint64_t> exported;
+    f5::stats::read().each([&](char const *name, std::uint64_t const value) {
+        exported[name] = value;
+    });
+    assert(exported.size() == f5::stats::counters);
+    assert(exported["concatenations"] >= 2u);
+
+    return 0;
+}
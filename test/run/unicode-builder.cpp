@@ -0,0 +1,127 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/unicode-builder.hpp>
+
+#include <cstring>
+#include <string>
+
+
+int main() {
+    {
+        f5::u8string_builder b;
+        assert(b.empty());
+        assert(b.finish().empty());
+    }
+    {
+        f5::u8string_builder b;
+        b.append("Hello").append(' ').append(U'w').append("orld ");
+        b.append(0x2713).append(0x1f603);
+        assert(b.code_units() == 19u);
+        auto const s = b.finish();
+        assert(s == "Hello world \xE2\x9C\x93\xF0\x9F\x98\x83");
+        assert(b.empty());
+    }
+    {
+        f5::u8string_builder b;
+        try {
+            b.append(0xd800);
+            assert(false);
+        } catch (std::domain_error &) {}
+        b.append<void>(0xd800);
+        assert(b.finish() == "\xEF\xBF\xBD");
+    }
+
+    /// Long strings are handed over without copying
+    {
+        f5::u8string_builder b{100u};
+        assert(b.capacity() == 100u);
+        b.append("A string that is too long ");
+        auto const p = b.snapshot().data();
+        b.append("to be stored inline");
+        auto s = b.finish();
+        assert(s == "A string that is too long to be stored inline");
+        assert(s.data() == p);
+        assert(s.is_shared());
+        /// The string is NUL terminated so this needs no new allocation
+        assert(s.shrink_to_fit() == p);
+        assert(std::strlen(p) == s.code_units());
+    }
+
+    /// Snapshots share the allocation, and don't change as the builder
+    /// carries on
+    {
+        f5::u8string_builder b{200u};
+        b.append("The first snapshot is too long to be inline.");
+        auto const first = b.snapshot();
+        assert(first.is_shared());
+        b.append(" The second is longer.");
+        auto second = b.snapshot();
+        assert(first.shares_allocation_with(second));
+        assert(first == "The first snapshot is too long to be inline.");
+        assert(second
+               == "The first snapshot is too long to be inline. The second "
+                  "is longer.");
+        /// The snapshot isn't NUL terminated so `shrink_to_fit` copies it
+        auto const p = second.data();
+        assert(second.shrink_to_fit() != p);
+        assert(second
+               == "The first snapshot is too long to be inline. The second "
+                  "is longer.");
+
+        /// Growing past the capacity moves to a new allocation, and the
+        /// snapshots keep the old one
+        std::string expected{first};
+        expected += " The second is longer.";
+        for (std::size_t n{}; n < 100u; ++n) {
+            b.append(" more");
+            expected += " more";
+        }
+        assert(b.capacity() >= 400u);
+        auto const all = b.finish();
+        assert(all == expected);
+        assert(not all.shares_allocation_with(first));
+        assert(first == "The first snapshot is too long to be inline.");
+    }
+
+    /// Finishing while a snapshot shares the allocation leaves the control
+    /// block alone, so the string is treated as not NUL terminated
+    {
+        f5::u8string_builder b{100u};
+        b.append("A snapshot that is too long to be inline");
+        auto const snapshot = b.snapshot();
+        auto s = b.finish();
+        assert(s.shares_allocation_with(snapshot));
+        auto const p = s.data();
+        assert(s.shrink_to_fit() != p);
+        assert(s == "A snapshot that is too long to be inline");
+    }
+
+    /// Formatted output goes straight into the buffer, growing it if
+    /// needed
+    {
+        f5::u8string_builder b;
+        b.append_formatted("%d-%s", 42, "abc");
+        assert(b.code_units() == 6u);
+        assert(b.snapshot() == "42-abc");
+        b.reserve(10u);
+        std::string expected{"42-abc"};
+        for (int n{}; n < 200; ++n) {
+            b.append_formatted(" %04d", n);
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), " %04d", n);
+            expected += buffer;
+        }
+        auto const s = b.finish();
+        assert(s == expected);
+    }
+
+    return 0;
+}
@@ -0,0 +1,44 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/unicode-string.hpp>
+
+#include <iterator>
+
+
+int main() {
+    if (not f5::cord::simd::cpu_supported()) return 0;
+
+    assert(f5::u8view{}.code_points() == 0u);
+    assert(f5::u8view{"Hello"}.code_points() == 5u);
+    assert(f5::u8view{"Hello world \xF0\x9F\x98\x83"}.code_points() == 13u);
+    assert(f5::u16view{u"Hello world \xD83D\xDE03"}.code_points() == 13u);
+    assert(f5::u32view{U"Hello world \x1F603"}.code_points() == 13u);
+    assert(f5::u8string{u"Hello world \xD83D\xDE03"}.code_points() == 13u);
+
+    /// Check the counts match iteration for mixed strings of every length
+    /// up to a few vectors long
+    char const *const u8s[] = {"a", "\xC3\xA6", "\xE2\x9C\x93", "\xF0\x9F\x98\x83"};
+    char16_t const *const u16s[] = {u"a", u"\x2713", u"\xD83D\xDE03"};
+    std::string s8;
+    std::u16string s16;
+    for (std::size_t c{}; c < 300u; ++c) {
+        s8 += u8s[(c * 7) % 4];
+        s16 += u16s[(c * 5) % 3];
+        f5::u8view const v8{s8.data(), s8.size()};
+        assert(v8.code_points() == std::size_t(std::distance(v8.begin(), v8.end())));
+        f5::u16view const v16{s16.data(), s16.size()};
+        assert(v16.code_points()
+               == std::size_t(std::distance(v16.begin(), v16.end())));
+        assert(f5::u32string{U"\x1F603\x2713"}.code_points() == 2u);
+    }
+
+    return 0;
+}
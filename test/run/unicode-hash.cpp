@@ -0,0 +1,87 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/unicode-hash.hpp>
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+
+namespace {
+    f5::u8view view(std::string const &s) {
+        return f5::u8view{s.data(), s.size()};
+    }
+}
+
+
+int main() {
+    /// Equal content hashes the same however it is held
+    std::string const text{
+            "A string that is long enough to go through every part of the "
+            "hash function, which takes 48 bytes at a time"};
+    f5::u8string const long_string{text};
+    for (std::size_t length{}; length <= text.size(); ++length) {
+        auto const v = view(text).substr(0u).memory().slice(0u, length);
+        f5::u8view const part{
+                reinterpret_cast<char const *>(v.data()), v.size()};
+        f5::u8string const copy{part};
+        assert(f5::cord::hash(part) == f5::cord::hash(copy));
+        assert(std::hash<f5::u8view>{}(part) == std::hash<f5::u8string>{}(copy));
+        auto const sub = long_string.substr_pos(0u, length);
+        assert(f5::cord::hash(sub) == f5::cord::hash(part));
+        /// Every byte matters
+        for (std::size_t pos{}; pos < length; ++pos) {
+            std::string changed{text, 0u, length};
+            changed[pos] ^= 1;
+            assert(f5::cord::hash(view(changed)) != f5::cord::hash(part));
+        }
+    }
+    assert(f5::cord::hash(f5::u8view{}) == f5::cord::hash(f5::u8string{}));
+    assert(f5::cord::hash(f5::u16view{u"Hello"})
+           == f5::cord::hash(f5::u16string{u"Hello"}));
+    assert(f5::cord::hash(f5::u32view{U"Hello"})
+           != f5::cord::hash(f5::u32view{U"Hellp"}));
+
+    /// No collisions for a lot of similar keys
+    std::set<std::uint64_t> seen;
+    for (std::size_t n{}; n < 100'000u; ++n) {
+        auto const s = "key-" + std::to_string(n);
+        assert(seen.insert(f5::cord::hash(view(s))).second);
+    }
+
+    /// The standard containers work
+    std::unordered_map<f5::u8string, int> counts;
+    ++counts[f5::u8string{"Hello"}];
+    ++counts[long_string];
+    ++counts[f5::u8string{text}];
+    assert(counts.size() == 2u);
+    assert(counts[long_string] == 2);
+    std::unordered_set<f5::u8view> views{"a", "b", "a"};
+    assert(views.size() == 2u);
+
+#if defined(F5_CORD_HASH_CACHE)
+    /// The hash of a whole allocation is kept in its control block
+    f5::u8string const fresh{text};
+    assert(fresh.control_block()->user_data.hash == 0u);
+    auto const h = f5::cord::hash(fresh);
+    assert(fresh.control_block()->user_data.hash == h);
+    auto const copy = fresh;
+    assert(f5::cord::hash(copy) == h);
+    /// Substrings don't use it
+    auto const sub = fresh.substr(1u);
+    assert(sub.shares_allocation_with(fresh));
+    assert(f5::cord::hash(sub) != h);
+    assert(f5::cord::hash(sub) == f5::cord::hash(view(text.substr(1u))));
+#endif
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/control-pool.hpp>
+#include <f5/cord/unicode-builder.hpp>
+#include <f5/cord/unicode-string.hpp>
+
+#include <algorithm>
+
+
+namespace {
+    bool same(f5::u8view const l, f5::u32view const r) {
+        return std::equal(l.begin(), l.end(), r.begin(), r.end());
+    }
+    f5::u32view view32(std::u32string const &s) {
+        return f5::u32view{s.data(), s.size()};
+    }
+    bool indexed([[maybe_unused]] f5::u8view const v) {
+#if defined(F5_CORD_CODE_POINT_INDEX)
+        return v.control_block()->user_data.index.load() != nullptr;
+#else
+        return false;
+#endif
+    }
+
+    /// Substrings taken using the index must match walking the code
+    /// points, for the string and for views part way into it
+    void check(f5::u8string const &str, std::u32string const &u32) {
+        auto const v32 = view32(u32);
+        assert(str.code_points() == u32.size());
+        for (std::size_t start{}; start <= u32.size() + 1u; start += 97u) {
+            auto const sub = str.substr(start);
+            assert(same(sub, v32.substr(start)));
+            assert(sub.is_inline() || sub.shares_allocation_with(str));
+            auto const len = start % 1000u;
+            assert(same(
+                    str.substr_pos(start, start + len),
+                    v32.substr_pos(start, start + len)));
+            f5::u8view const view = sub;
+            for (std::size_t s{}; s < 600u; s += 131u) {
+                assert(same(view.substr(s), v32.substr(start + s)));
+                assert(same(
+                        view.substr_pos(s, s + 300u),
+                        v32.substr(start).substr_pos(s, s + 300u)));
+            }
+        }
+        assert(same(str.substr_pos(0, u32.size()), v32));
+        assert(str.substr(u32.size()).empty());
+        assert(str.substr(f5::u8view::npos).empty());
+        assert(same(str.substr_pos(10, f5::u8view::npos), v32.substr(10)));
+    }
+}
+
+
+int main() {
+    if (not f5::cord::simd::cpu_supported()) return 0;
+
+    constexpr bool enabled =
+#if defined(F5_CORD_CODE_POINT_INDEX)
+            true;
+#else
+            false;
+#endif
+
+    /// A long string with multi-byte code points in amongst the ASCII
+    std::string s;
+    std::u32string u32;
+    for (std::size_t c{}; c < 20000u; ++c) {
+        if (c % 7u == 0u) {
+            s += "\xE2\x9C\x93";
+            u32 += U'\x2713';
+        } else if (c % 11u == 0u) {
+            s += "\xF0\x9F\x98\x83";
+            u32 += U'\x1F603';
+        } else {
+            s += char('a' + c % 26);
+            u32 += char32_t('a' + c % 26);
+        }
+    }
+    {
+        f5::u8string const str{s};
+        assert(not indexed(str));
+        check(str, u32);
+        assert(indexed(str) == enabled);
+    }
+    {
+        /// A view into part of the allocation can't build the index, but
+        /// uses it once it's there
+        f5::u8string const str{s};
+        auto from = str.begin();
+        for (std::size_t c{}; c < 100u; ++c) ++from;
+        f5::u8view const part{from, str.end()};
+        assert(same(part.substr(5000), view32(u32).substr(5100)));
+        assert(not indexed(str));
+        str.substr(1);
+        assert(indexed(part) == enabled);
+        assert(same(part.substr(5000), view32(u32).substr(5100)));
+    }
+    {
+        /// All ASCII
+        std::string const ascii(10000u, 'x');
+        f5::u8string const str{ascii};
+        check(str, std::u32string(10000u, U'x'));
+    }
+    {
+        /// Strings from a builder are indexed once finished
+        f5::u8string_builder b;
+        b.append(f5::u8view{s.data(), s.size()});
+        {
+            auto const snapshot = b.snapshot();
+            assert(same(snapshot.substr(9000), view32(u32).substr(9000)));
+            assert(not indexed(snapshot));
+        }
+        auto const str = b.finish();
+        check(str, u32);
+        assert(indexed(str) == enabled);
+    }
+    {
+        /// Unless a snapshot still shares the allocation
+        f5::u8string_builder b;
+        b.append(f5::u8view{s.data(), s.size()});
+        auto const snapshot = b.snapshot();
+        auto const str = b.finish();
+        check(str, u32);
+        assert(not indexed(str));
+    }
+    {
+        /// The index is released along with pooled control blocks
+        f5::control_pool::install();
+        f5::u8string const str{s};
+        check(str, u32);
+        assert(indexed(str) == enabled);
+        f5::control_pool::uninstall();
+    }
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/unicode.hpp>
+
+#include <string>
+#include <vector>
+
+
+int main() {
+    using control = f5::u8view::control_type;
+    std::string const body(1000u, 'b');
+    std::string const text = std::string(40u, 'k') + body;
+
+    /// A substring keeps all of its parent alive
+    {
+        std::vector<f5::u8string> keys;
+        {
+            f5::u8string const request{text};
+            keys.emplace_back(f5::u8view{request}.substr_pos(0u, 20u));
+            keys.emplace_back(f5::u8view{request}.substr_pos(10u, 40u));
+            auto const r = f5::cord::retention(request);
+            assert(r.referenced == 1040u);
+            assert(r.retained == 1040u);
+            assert(r.unused() == 0u);
+        }
+        auto const key = f5::cord::retention(keys[0]);
+        assert(key.block == keys[0].control_block());
+        assert(key.referenced == 20u);
+        assert(key.retained == 1040u);
+        assert(key.unused() == 1020u);
+
+        auto const blocks = f5::cord::retention_by_block(keys);
+        assert(blocks.size() == 1u);
+        assert(blocks[0].strings == 2u);
+        assert(blocks[0].referenced == 40u);
+        assert(blocks[0].retained == 1040u);
+
+        /// Compacting gives them a single allocation of their own
+        assert(f5::cord::compact(keys) == 2u);
+        assert(keys[0] == std::string(20u, 'k'));
+        assert(keys[1] == std::string(30u, 'k'));
+        assert(keys[0].control_block() == keys[1].control_block());
+        assert(control::owners(keys[0].control_block()) == 2u);
+        auto const compacted = f5::cord::retention_by_block(keys);
+        assert(compacted.size() == 1u);
+        assert(compacted[0].retained < 60u);
+
+        /// Doing it again moves nothing
+        assert(f5::cord::compact(keys) == 0u);
+        /// But it does once one of them has gone
+        keys.erase(keys.begin() + 1);
+        assert(f5::cord::compact(keys) == 1u);
+        assert(control::owners(keys[0].control_block()) == 1u);
+        /// A single string's allocation is NUL terminated already
+        auto const data = keys[0].data();
+        assert(keys[0].shrink_to_fit() == data);
+        assert(keys[0] == std::string(20u, 'k'));
+    }
+
+    /// Strings using all of an allocation stay where they are
+    {
+        f5::u8string const parent{text};
+        std::vector<f5::u8string> keys{
+                f5::u8string{f5::u8view{parent}.substr_pos(1000u, 1040u)},
+                parent};
+        assert(f5::cord::compact(keys) == 1u);
+        assert(keys[0].control_block() != parent.control_block());
+        assert(keys[0] == std::string(40u, 'b'));
+        assert(keys[1].control_block() == parent.control_block());
+        /// Short substrings are inline, so retain nothing
+        f5::u8string const key{f5::u8view{parent}.substr_pos(0u, 5u)};
+        if (key.is_inline()) {
+            assert(f5::cord::retention(key).retained == 0u);
+        }
+    }
+
+    /// The compaction policy copies slices as they are made
+    f5::cord::compaction::policy = f5::cord::compaction::below<10, 1000>;
+    {
+        f5::u8string const parent{text};
+        f5::u8string const small{f5::u8view{parent}.substr_pos(0u, 60u)};
+        assert(small.control_block() != parent.control_block());
+        assert(f5::cord::retention(small).unused() == 0u);
+        f5::u8string const large{f5::u8view{parent}.substr_pos(0u, 500u)};
+        assert(large.control_block() == parent.control_block());
+        f5::u8string const from_iterators{parent.begin(), parent.end()};
+        assert(from_iterators.control_block() == parent.control_block());
+
+        f5::u8string const little{std::string(200u, 'l')};
+        f5::u8string const tiny{f5::u8view{little}.substr_pos(0u, 16u)};
+        assert(tiny.control_block() == little.control_block());
+    }
+    f5::cord::compaction::policy = nullptr;
+    {
+        f5::u8string const parent{text};
+        f5::u8string const small{f5::u8view{parent}.substr_pos(0u, 60u)};
+        assert(small.control_block() == parent.control_block());
+    }
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/unicode.hpp>
+
+#include <algorithm>
+#include <vector>
+
+
+namespace {
+    template<typename V>
+    std::vector<f5::utf32> backwards(V const &v) {
+        std::vector<f5::utf32> cps;
+        for (auto p = v.end(); p != v.begin();) cps.push_back(*--p);
+        return cps;
+    }
+    template<typename V>
+    std::vector<f5::utf32> reversed(V const &v) {
+        std::vector<f5::utf32> cps(v.begin(), v.end());
+        std::reverse(cps.begin(), cps.end());
+        return cps;
+    }
+    template<typename V>
+    void check(V const &v) {
+        auto const expected = reversed(v);
+        assert(backwards(v) == expected);
+        assert(std::equal(
+                v.rbegin(), v.rend(), expected.begin(), expected.end()));
+        /// Forwards and backwards again from every position
+        for (auto p = v.begin(); p != v.end(); ++p) {
+            auto q = p;
+            ++q;
+            --q;
+            assert(q == p);
+            assert(*q == *p);
+        }
+    }
+}
+
+
+int main() {
+    char const text[] =
+            "a\xC2\xA2 \xE2\x82\xAC\xF0\x90\x8D\x88z \xF4\x8F\xBF\xBF";
+    check(f5::u8view{text});
+    check(f5::u8string{text});
+    check(f5::u8string{"\xE2\x82\xAC"});
+    check(f5::u8view{});
+    check(f5::u16view{u"a\xD83D\xDE03 b\xD800\xDC00"});
+    check(f5::u32view{U"a\x1F603 b"});
+
+    /// A view part way into a string only moves back as far as its start
+    {
+        f5::u8string const s{"\xE2\x82\xAC\xE2\x82\xAC and some more text"};
+        auto const tail = s.substr(1);
+        assert(*tail.rbegin() == 't');
+        assert(backwards(tail).back() == 0x20ac);
+        assert(backwards(tail).size() == tail.code_points());
+    }
+    /// Invalid sequences are found moving backwards too
+    {
+        std::string const bad{"\x80\x80" "a"};
+        f5::u8view const v{bad.data(), bad.size()};
+        auto p = v.end();
+        assert(*--p == 'a');
+        try {
+            --p;
+            assert(false);
+        } catch (std::range_error &) {}
+    }
+
+    /// Suffix checks only look at the end of the string
+    {
+        f5::u8view const path{"/static/\xE2\x9C\x93/index.html"};
+        assert(path.ends_with(".html"));
+        assert(path.ends_with("\xE2\x9C\x93/index.html"));
+        assert(path.ends_with(""));
+        assert(path.ends_with(path));
+        assert(not path.ends_with(".htm"));
+        assert(not path.ends_with("x/static/\xE2\x9C\x93/index.html"));
+        assert(f5::u8string{path}.ends_with("index.html"));
+        assert(f5::u16view{u"file.\xD83D\xDE03"}.ends_with(u".\xD83D\xDE03"));
+    }
+
+    /// Searching from the end
+    {
+        f5::u8string const name{"archive.\xE2\x9C\x93.tar.gz"};
+        auto const dot = name.rfind(".");
+        assert(f5::u8view(dot, name.end()) == ".gz");
+        auto const tick = name.rfind("\xE2\x9C\x93");
+        assert(f5::u8view(tick, name.end()) == "\xE2\x9C\x93.tar.gz");
+        assert(name.rfind("zip") == name.end());
+        assert(name.rfind("") == name.end());
+        /// The iterator found can go backwards too
+        auto before = name.rfind(".tar");
+        assert(*--before == 0x2713);
+        f5::u16view const u16{u"a.b.c"};
+        assert(f5::u16view(u16.rfind(u"."), u16.end()) == u".c");
+    }
+
+    return 0;
+}
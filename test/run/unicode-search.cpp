@@ -0,0 +1,143 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/unicode.hpp>
+
+#include <string>
+
+
+namespace {
+    template<typename V, typename S>
+    V view(S const &s) {
+        return V{s.data(), s.size()};
+    }
+
+    /// Check the offsets match `std::basic_string_view` for every needle
+    /// taken from the text
+    template<typename V, typename S>
+    void check(S const &text) {
+        auto const v = view<V>(text);
+        std::basic_string_view<typename S::value_type> const sv{text};
+        for (std::size_t s{}; s < text.size(); s += 7u) {
+            for (std::size_t m : {1u, 2u, 3u, 5u, 17u, 40u}) {
+                auto const needle = text.substr(s, m);
+                auto const n = view<V>(needle);
+                assert(v.find_offset(n) == sv.find(needle));
+                assert(v.rfind_offset(n) == sv.rfind(needle));
+                assert(v.contains(n));
+            }
+        }
+        S missing(3u, typename S::value_type('#'));
+        assert(v.find_offset(view<V>(missing)) == V::npos);
+        assert(v.rfind_offset(view<V>(missing)) == V::npos);
+        assert(not v.contains(view<V>(missing)));
+        assert(v.find(view<V>(missing)) == v.end());
+    }
+
+    template<typename S>
+    S repeat(S const &s, std::size_t const times) {
+        S r;
+        for (std::size_t t{}; t < times; ++t) r += s;
+        return r;
+    }
+}
+
+
+int main() {
+    if (not f5::cord::simd::cpu_supported()) return 0;
+
+    /// Long enough to need several vectors, with the matches at
+    /// every alignment
+    check<f5::u8view>(repeat(
+            std::string{"The quick \xE2\x9C\x93 brown fox \xF0\x9F\x98\x83, "},
+            9u));
+    check<f5::u16view>(
+            repeat(std::u16string{u"The quick \x2713 fox \xD83D\xDE03, "}, 9u));
+    check<f5::u32view>(
+            repeat(std::u32string{U"The quick \x2713 fox \x1F603, "}, 9u));
+
+    /// Code points are found whatever their encoding
+    f5::u8view const text{"Caf\xC3\xA9 and cr\xC3\xA8me \xF0\x9F\x98\x83!"};
+    assert(text.find_offset(U'\xE9') == 3u);
+    assert(text.rfind_offset(U'\x1F603') == 17u);
+    assert(text.find_offset(U'z') == f5::u8view::npos);
+    assert(text.contains(U'\xE8'));
+    assert(*text.find(U'\xE8') == U'\xE8');
+    assert(f5::u16view{u"a\xD83D\xDE03z"}.find_offset(U'\x1F603') == 1u);
+    assert(f5::u32view{U"a\x1F603z"}.rfind_offset(U'z') == 2u);
+
+    /// An empty needle matches at both ends
+    assert(text.find_offset(f5::u8view{}) == 0u);
+    assert(text.rfind_offset(f5::u8view{}) == text.code_units());
+    assert(f5::u8view{}.find_offset(U'a') == f5::u8view::npos);
+
+    /// Counting doesn't overlap matches
+    assert(f5::u8view{"aaaaa"}.count("aa") == 2u);
+    assert(f5::u8view{"aaaaa"}.count(U'a') == 5u);
+    assert(f5::u8view{"aaaaa"}.count(f5::u8view{}) == 0u);
+    auto const many = repeat(std::string{"ab\xE2\x9C\x93 "}, 50u);
+    assert(view<f5::u8view>(many).count(U'\x2713') == 50u);
+    assert(view<f5::u8view>(many).count("b\xE2\x9C\x93") == 50u);
+    assert(view<f5::u8view>(many).count(" ") == 50u);
+    auto const many16 = repeat(std::u16string{u"\xD83D\xDE03-"}, 50u);
+    assert(view<f5::u16view>(many16).count(U'\x1F603') == 50u);
+
+    /// Sets of code points, with single and multiple code units
+    assert(text.find_first_of_offset(" !") == 5u);
+    assert(text.find_first_of_offset("\xC3\xA8!") == 12u);
+    assert(text.find_first_of_offset("\xF0\x9F\x98\x83") == 17u);
+    assert(text.find_first_of_offset("xyz") == f5::u8view::npos);
+    assert(text.find_first_of_offset(f5::u8view{}) == f5::u8view::npos);
+    assert(*text.find_first_of("\xC3\xA8\xC3\xA9") == U'\xE9');
+    /// A continuation byte of a code point in the set doesn't match
+    /// inside another code point
+    assert(f5::u8view{"\xC3\xA9\xC2\xA9"}.find_first_of_offset("\xC2\xA9")
+           == 2u);
+    /// More first code units than can be compared a vector at a time
+    auto const long_line =
+            repeat(std::string{"abcdefghijklmnop"}, 8u) + "\xC3\xA9;";
+    assert(view<f5::u8view>(long_line).find_first_of_offset(
+                   "0123456789;\xC3\xA9")
+           == 128u);
+    assert(view<f5::u8view>(long_line).find_first_of_offset(
+                   "0123456789;")
+           == 130u);
+    auto const line16 = repeat(std::u16string{u"abcdefghijklmnop"}, 8u)
+            + u"\xD83D\xDE03;";
+    assert(view<f5::u16view>(line16).find_first_of_offset(u";\xD83D\xDE03")
+           == 128u);
+    assert(view<f5::u16view>(line16).find_first_of_offset(
+                   u"0123456789;\xD83D\xDE03")
+           == 128u);
+    assert(f5::u16view{u"\xD83C\xDE03;\xD83D\xDE03"}.find_first_of_offset(
+                   u"\xD83D\xDE03")
+           == 3u);
+    auto const line32 =
+            repeat(std::u32string{U"abcdefghijklmnop"}, 8u) + U"\x1F603";
+    assert(view<f5::u32view>(line32).find_first_of_offset(U"0123456789\x1F603")
+           == 128u);
+
+    /// The iterators found keep the string's allocation
+    {
+        f5::u8string const s{
+                repeat(std::string{"some \xE2\x9C\x93 text "}, 4u)};
+        auto const found = s.find(U'\x2713');
+        f5::u8view const tail{found, s.end()};
+        assert(tail.shares_allocation_with(s));
+        assert(tail.starts_with("\xE2\x9C\x93 text"));
+        assert(s.rfind("text") != s.end());
+        assert(f5::u8view(s.rfind("text"), s.end()) == "text ");
+        assert(s.count("text") == 4u);
+        assert(s.contains(U'\x2713'));
+        assert(s.find_first_of_offset("\xE2\x9C\x93") == 5u);
+    }
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/unicode.hpp>
+
+#include <string>
+#include <vector>
+
+
+namespace {
+    template<typename R>
+    std::vector<std::string> parts(R const &range) {
+        std::vector<std::string> p;
+        for (auto const &v : range) p.emplace_back(v.data(), v.code_units());
+        return p;
+    }
+    using strings = std::vector<std::string>;
+}
+
+
+int main() {
+    using f5::cord::lines;
+    using f5::cord::split;
+
+    f5::u8view const csv{"a,bc,,d\xE2\x9C\x93,"};
+    assert(parts(split(csv, ","))
+           == (strings{"a", "bc", "", "d\xE2\x9C\x93", ""}));
+    assert(parts(split(csv, U',')) == parts(split(csv, ",")));
+    assert(parts(split(csv, ",,")) == (strings{"a,bc", "d\xE2\x9C\x93,"}));
+    assert(parts(split(csv, U'\x2713')) == (strings{"a,bc,,d", ","}));
+    assert(parts(split(csv, "\xE2\x9C\x93,")) == (strings{"a,bc,,d", ""}));
+    assert(parts(split(csv, ";")) == (strings{std::string{csv}}));
+    assert(parts(split(csv, f5::u8view{})) == (strings{std::string{csv}}));
+    assert(parts(split(f5::u8view{}, ",")) == (strings{""}));
+
+    assert(parts(lines(f5::u8view{"one\ntwo\r\n\nfour"}))
+           == (strings{"one", "two", "", "four"}));
+    assert(parts(lines(f5::u8view{"one\n"})) == (strings{"one"}));
+    assert(parts(lines(f5::u8view{"\n"})) == (strings{""}));
+    assert(parts(lines(f5::u8view{"a\r"})) == (strings{"a\r"}));
+    assert(parts(lines(f5::u8view{"a\r\nb\r"})) == (strings{"a", "b\r"}));
+    assert(parts(lines(f5::u8view{})).empty());
+
+    /// Counting the parts without splitting
+    assert(split(csv, ",").count() == 5u);
+    assert(split(csv, ",,").count() == 2u);
+    assert(split(csv, f5::u8view{}).count() == 1u);
+    assert(split(f5::u8view{}, ",").count() == 1u);
+    assert(lines(f5::u8view{"one\ntwo\r\n\nfour"}).count() == 4u);
+    assert(lines(f5::u8view{"one\n"}).count() == 1u);
+    assert(lines(f5::u8view{}).count() == 0u);
+
+    /// The other encodings
+    std::u16string const u16{u"x\xD83D\xDE03y\xD83D\xDE03"};
+    f5::u16view const v16{u16.data(), u16.size()};
+    std::size_t count{};
+    for (auto const &part : split(v16, U'\x1F603')) {
+        assert(part.code_units() == (count < 2u ? 1u : 0u));
+        ++count;
+    }
+    assert(count == 3u);
+    count = 0u;
+    for (auto const &part : lines(f5::u32view{U"a\nb"})) {
+        assert(part.code_units() == 1u);
+        ++count;
+    }
+    assert(count == 2u);
+
+    /// The parts share the string's control block
+    std::string text;
+    for (std::size_t n{}; n < 600u; ++n) {
+        text += "a line long enough not to be inline " + std::to_string(n)
+                + "\n";
+    }
+    text += "short\n";
+    f5::u8string const file{text};
+    for (auto const &line : lines(file)) {
+        assert(line.shares_allocation_with(file));
+    }
+    auto const first = *lines(file).begin();
+    assert(first == "a line long enough not to be inline 0");
+
+    std::vector<f5::u8string> out;
+    assert(f5::cord::split_to(lines(file), out) == 601u);
+    assert(out.size() == 601u);
+    assert(out[599] == "a line long enough not to be inline 599");
+    assert(out[600] == "short");
+    assert(out[600].is_inline());
+    assert(out[0].control_block() == file.control_block());
+    using control = f5::u8view::control_type;
+    assert(control::owners(file.control_block()) == 601u);
+    out.erase(out.begin() + 100, out.end());
+    assert(control::owners(file.control_block()) == 101u);
+    out.clear();
+    assert(control::owners(file.control_block()) == 1u);
+
+    /// Views of memory not owned by a string are copied
+    f5::cord::split_to(lines(f5::u8view{text.data(), text.size()}), out);
+    assert(out.size() == 601u);
+    assert(out[5].control_block() != nullptr);
+    assert(out[5].control_block() != out[6].control_block());
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/unicode-stream.hpp>
+
+#include <string>
+#include <vector>
+
+
+namespace {
+    f5::cord::const_u8buffer buffer(std::string const &s) {
+        return f5::cord::const_u8buffer{s.data(), s.size()};
+    }
+    template<std::size_t N>
+    f5::cord::const_u8buffer buffer(char const (&s)[N]) {
+        return f5::cord::const_u8buffer{s, N - 1u};
+    }
+
+    /// Feed the string in pieces split at the given positions and return
+    /// the valid output, and whether the stream was valid and complete
+    std::pair<std::string, bool> feed(
+            std::string const &s, std::vector<std::size_t> const &splits) {
+        f5::u8stream_validator validator;
+        std::string out;
+        std::size_t start{};
+        for (auto const end : splits) {
+            auto const r = validator.feed(
+                    buffer(s).slice(start, end - start));
+            out += static_cast<std::string_view>(r.joined);
+            out += static_cast<std::string_view>(r.valid);
+            assert(r.error == validator.error());
+            start = end;
+        }
+        return {out, validator.finish()};
+    }
+
+    /// Check every way of splitting the string into up to three chunks
+    /// gives the same answer as validating it all at once
+    void check(std::string const &s) {
+        auto const length = f5::cord::valid_length(buffer(s));
+        auto const whole = std::string{s.data(), length};
+        for (std::size_t a{}; a <= s.size(); ++a) {
+            for (std::size_t b{a}; b <= s.size(); ++b) {
+                auto const [out, ok] = feed(s, {a, b, s.size()});
+                assert(ok == (length == s.size()));
+                if (ok) {
+                    assert(out == s);
+                } else {
+                    /// The output stops at or before the first error
+                    assert(out.size() <= length);
+                    assert(whole.compare(0, out.size(), out) == 0);
+                }
+            }
+        }
+    }
+}
+
+
+int main() {
+    if (not f5::cord::simd::cpu_supported()) return 0;
+
+    /// Whole code points and everything split one byte at a time
+    check("");
+    check("Hello world");
+    check("\xC2\xA2 \xE2\x82\xAC \xF0\x90\x8D\x88 \xF4\x8F\xBF\xBF");
+    std::string const mixed =
+            "Some text that is long enough to fill a vector or two, with "
+            "the odd \xE2\x9C\x93 and \xF0\x9F\x98\x83 along the way \xC3\xA9";
+    check(mixed);
+    {
+        std::vector<std::size_t> everywhere;
+        for (std::size_t p{1}; p <= mixed.size(); ++p) everywhere.push_back(p);
+        auto const [out, ok] = feed(mixed, everywhere);
+        assert(ok);
+        assert(out == mixed);
+    }
+
+    /// Errors whether or not they are split
+    check("\x80");
+    check("abc\xC0\xAF");
+    check("abc\xE0\x80\xAF def");
+    check("abc\xED\xA0\x80 def");
+    check("abc\xF4\x90\x80\x80 def");
+    check("abc\xF5\x80\x80\x80 def");
+    check("abc\xE2\x82 def");
+    check("abc\xF0\x9F\x98");
+    check(mixed + "\xF0\x9F\x98\x83\x83" + mixed);
+
+    {
+        /// A code point left incomplete is held on to
+        f5::u8stream_validator v;
+        auto const first = v.feed(buffer("ab\xE2\x82"));
+        assert(first.valid == "ab");
+        assert(first.joined.empty());
+        assert(v.carried() == 2u);
+        assert(not v.finish());
+        auto const second = v.feed(buffer("\xAC!"));
+        assert(second.joined == "\xE2\x82\xAC");
+        assert(second.valid == "!");
+        assert(v.carried() == 0u);
+        assert(v.finish());
+    }
+    {
+        /// After an error nothing more is accepted until reset
+        f5::u8stream_validator v;
+        auto const bad = v.feed(buffer("ok\xFF"));
+        assert(bad.error);
+        assert(bad.valid == "ok");
+        assert(v.feed(buffer("more")).error);
+        v.reset();
+        assert(v.feed(buffer("more")).valid == "more");
+        assert(v.finish());
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/unicode-string.hpp>
+
+#include <algorithm>
+
+
+namespace {
+    bool same(f5::u8view const l, f5::u32view const r) {
+        return std::equal(l.begin(), l.end(), r.begin(), r.end());
+    }
+}
+
+
+int main() {
+    if (not f5::cord::simd::cpu_supported()) return 0;
+
+    /// Long runs of ASCII broken up by multi-byte code points at every
+    /// position in a vector
+    for (std::size_t gap{1u}; gap < 80u; gap += 3u) {
+        std::string s;
+        std::u32string u32;
+        for (std::size_t c{}; c < 400u; ++c) {
+            if (c % gap == 0u) {
+                s += "\xE2\x9C\x93";
+                u32 += U'\x2713';
+            } else {
+                s += char('a' + c % 26);
+                u32 += char32_t('a' + c % 26);
+            }
+        }
+        f5::u8string const str{s};
+        f5::u32view const v32{u32.data(), u32.size()};
+        assert(str.code_points() == u32.size());
+        for (std::size_t start{}; start <= u32.size() + 1u; start += 7u) {
+            auto const sub = str.substr(start);
+            assert(same(sub, v32.substr(start)));
+            assert(sub.is_inline() || sub.shares_allocation_with(str));
+            assert(str.ends_with(sub));
+            auto const len = start / 3u;
+            assert(same(
+                    str.substr_pos(start, start + len),
+                    v32.substr_pos(start, start + len)));
+        }
+    }
+
+    assert(*f5::u8view{"a\xE2\x9C\x93"}.substr(1).begin() == 0x2713);
+    assert(f5::u16view{u"\xD83D\xDE03z"}.substr(1) == u"z");
+    assert(f5::u32view{U"\x1F603z"}.substr(1) == U"z");
+
+    return 0;
+}
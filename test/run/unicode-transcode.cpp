@@ -0,0 +1,261 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/literals.hpp>
+#include <f5/cord/unicode-string.hpp>
+
+#include <algorithm>
+#include <vector>
+
+
+namespace {
+    char const *const u8s[] = {"a", "\xC3\xA6", "\xE2\x9C\x93", "\xF0\x9F\x98\x83"};
+
+    std::string mixed(std::size_t const length, std::size_t const step) {
+        std::string s;
+        for (std::size_t c{}; c < length; ++c) {
+            s += u8s[c % step ? 0 : (c / step) % 4];
+        }
+        return s;
+    }
+}
+
+
+int main() {
+    if (not f5::cord::simd::cpu_supported()) return 0;
+
+    /// ## UTF-8 to UTF-16
+    assert(f5::cord::transcode<char16_t>("") == u"");
+    assert(f5::cord::transcode<char16_t>("Hello world \xF0\x9F\x98\x83")
+           == u"Hello world \xD83D\xDE03");
+    for (std::size_t step{1u}; step < 40u; step += 3u) {
+        for (std::size_t length{}; length < 200u; length += 7u) {
+            f5::u8string const s{mixed(length, step)};
+            std::u16string const expected{s.u16begin(), s.u16end()};
+            auto const u16 = f5::cord::transcode<char16_t>(s);
+            assert((u16 == f5::u16view{expected.data(), expected.size()}));
+            assert(u16.is_shared() || u16.is_inline());
+
+            std::vector<char16_t> out(s.code_units());
+            auto const written = f5::cord::transcode(
+                    f5::cord::const_u8buffer{s}, f5::cord::u16buffer{out});
+            assert(written.data() == out.data());
+            assert(std::equal(
+                    written.begin(), written.end(), expected.begin(),
+                    expected.end()));
+        }
+    }
+
+    /// The output buffer may be smaller than the input so long as the
+    /// UTF-16 fits
+    {
+        char16_t out[2];
+        auto const written = f5::cord::transcode(
+                f5::cord::const_u8buffer{"\xE2\x9C\x93", 3},
+                f5::cord::u16buffer{out});
+        assert(written.size() == 1u);
+        assert(out[0] == 0x2713);
+        try {
+            f5::cord::transcode(
+                    f5::cord::const_u8buffer{"abc", 3},
+                    f5::cord::u16buffer{out});
+            assert(false);
+        } catch (std::length_error &) {}
+    }
+
+    /// Invalid input
+    try {
+        f5::cord::transcode<char16_t>("abc\xED\xA0\x80");
+        assert(false);
+    } catch (std::range_error &) {}
+    assert((f5::cord::transcode<char16_t, void>("ab\xC0\x80z")
+            == u"ab\xFFFD\xFFFDz"));
+    assert((f5::cord::transcode<char16_t, void>("\xE2\x9C") == u"\xFFFD\xFFFD"));
+
+    /// ## UTF-16 to UTF-8
+    assert(f5::cord::transcode<char>(u"") == "");
+    assert(f5::cord::transcode<char>(u"Hello world \xD83D\xDE03")
+           == "Hello world \xF0\x9F\x98\x83");
+    for (std::size_t step{1u}; step < 40u; step += 3u) {
+        for (std::size_t length{}; length < 200u; length += 7u) {
+            std::string const expected{mixed(length, step)};
+            f5::u8string const s{expected};
+            std::u16string const u16{s.u16begin(), s.u16end()};
+            f5::u16view const v{u16.data(), u16.size()};
+            auto const u8 = f5::cord::transcode<char>(v);
+            assert(u8 == expected);
+            assert(u8.is_shared() || u8.is_inline());
+            assert(f5::u8string{v} == expected);
+
+            std::vector<char> out(3u * u16.size());
+            auto const written = f5::cord::transcode(
+                    f5::cord::const_u16buffer{v}, f5::cord::u8buffer{out});
+            assert(written.data() == out.data());
+            assert(std::equal(
+                    written.begin(), written.end(), expected.begin(),
+                    expected.end()));
+        }
+    }
+    assert(f5::u8string{u"\x2713"} == "\xE2\x9C\x93");
+    {
+        char out[3];
+        auto const written = f5::cord::transcode(
+                f5::cord::const_u16buffer{u"\x2713", 1},
+                f5::cord::u8buffer{out});
+        assert(written.size() == 3u);
+        try {
+            f5::cord::transcode(
+                    f5::cord::const_u16buffer{u"abcd", 4},
+                    f5::cord::u8buffer{out});
+            assert(false);
+        } catch (std::length_error &) {}
+    }
+    try {
+        f5::cord::transcode<char>(u"abc\xDE03");
+        assert(false);
+    } catch (std::range_error &) {}
+    try {
+        f5::u8string{u"\xD83D"};
+        assert(false);
+    } catch (std::range_error &) {}
+    assert((f5::cord::transcode<char, void>(u"a\xD83D" u"b\xDE03")
+            == "a\xEF\xBF\xBD" "b\xEF\xBF\xBD"));
+
+    /// ## UTF-32
+    assert(f5::cord::transcode<char>(U"\x1F603") == "\xF0\x9F\x98\x83");
+    assert(f5::cord::transcode<char32_t>(u"\xD83D\xDE03") == U"\x1F603");
+
+    /// ## Block decoding and encoding
+    for (std::size_t step{1u}; step < 40u; step += 3u) {
+        for (std::size_t length{}; length < 200u; length += 7u) {
+            std::string const u8{mixed(length, step)};
+            f5::u8string const s{u8};
+            std::u32string const expected{s.begin(), s.end()};
+
+            std::vector<char32_t> out(u8.size());
+            auto const [consumed, produced] = f5::cord::decode_into(
+                    f5::cord::const_u8buffer{s}, f5::cord::u32buffer{out});
+            assert(consumed == u8.size());
+            assert(produced == expected.size());
+            assert(std::equal(
+                    expected.begin(), expected.end(), out.begin(),
+                    out.begin() + produced));
+            assert((f5::u32string{f5::u8view{s}}
+                    == f5::u32view{expected.data(), expected.size()}));
+
+            std::vector<char> encoded(4u * expected.size());
+            auto const [used, bytes] = f5::cord::encode_into(
+                    f5::cord::const_u32buffer{expected.data(), expected.size()},
+                    f5::cord::u8buffer{encoded});
+            assert(used == expected.size());
+            assert(std::string(encoded.data(), bytes) == u8);
+            assert(f5::cord::transcode<char>(
+                           f5::u32view{expected.data(), expected.size()})
+                   == u8);
+
+            /// Feed the input through in small pieces, carrying the unused
+            /// bytes over to the next piece
+            for (std::size_t chunk{1u}; chunk < 9u; ++chunk) {
+                std::u32string decoded;
+                char32_t cps[3];
+                std::size_t pos{};
+                while (pos < u8.size()) {
+                    auto const end = std::min(u8.size(), pos + chunk);
+                    auto const [c, p] = f5::cord::decode_into(
+                            f5::cord::const_u8buffer{u8.data() + pos, end - pos},
+                            f5::cord::u32buffer{cps});
+                    decoded.append(cps, p);
+                    pos += c;
+                    if (not c) {
+                        assert(end - pos < 4u);
+                        assert(end < u8.size());
+                        pos = std::max(pos, end - chunk);
+                        auto const [c2, p2] = f5::cord::decode_into(
+                                f5::cord::const_u8buffer{
+                                        u8.data() + pos,
+                                        std::min(u8.size(), pos + 4u) - pos},
+                                f5::cord::u32buffer{cps});
+                        decoded.append(cps, p2);
+                        pos += c2;
+                    }
+                }
+                assert(decoded == expected);
+
+                std::string narrowed;
+                char bytes[5];
+                f5::cord::const_u32buffer remaining{
+                        expected.data(), expected.size()};
+                while (remaining.size()) {
+                    auto const [c, p] = f5::cord::encode_into(
+                            remaining,
+                            f5::cord::u8buffer{bytes, std::min(chunk, 5ul)});
+                    narrowed.append(bytes, p);
+                    remaining = remaining.slice(c);
+                    if (not c) {
+                        assert(chunk < 4u);
+                        auto const [c2, p2] = f5::cord::encode_into(
+                                remaining.slice(0, 1), f5::cord::u8buffer{bytes});
+                        narrowed.append(bytes, p2);
+                        remaining = remaining.slice(c2);
+                    }
+                }
+                assert(narrowed == u8);
+            }
+        }
+    }
+    {
+        char32_t out[4];
+        auto const [c, p] = f5::cord::decode_into(
+                f5::cord::const_u8buffer{"ab\xF0\x9F\x98", 5},
+                f5::cord::u32buffer{out});
+        assert(c == 2u);
+        assert(p == 2u);
+        try {
+            f5::cord::decode_into(
+                    f5::cord::const_u8buffer{"ab\xF0\x9F" "a", 5},
+                    f5::cord::u32buffer{out});
+            assert(false);
+        } catch (std::range_error &) {}
+        auto const [rc, rp] = f5::cord::decode_into<void>(
+                f5::cord::const_u8buffer{"a\xC0\x80", 3},
+                f5::cord::u32buffer{out});
+        assert(rc == 3u);
+        assert(rp == 3u);
+        assert(out[1] == 0xfffd);
+        assert(out[2] == 0xfffd);
+    }
+    {
+        char32_t const cps[] = {U'a', 0xd800, 0x110000};
+        char out[8];
+        try {
+            f5::cord::encode_into(
+                    f5::cord::const_u32buffer{cps}, f5::cord::u8buffer{out});
+            assert(false);
+        } catch (std::range_error &) {}
+        auto const [c, p] = f5::cord::encode_into<void>(
+                f5::cord::const_u32buffer{cps}, f5::cord::u8buffer{out});
+        assert(c == 3u);
+        assert((std::string(out, p) == "a\xEF\xBF\xBD\xEF\xBF\xBD"));
+    }
+    assert((f5::cord::transcode<char32_t, void>("a\xE2\x9C")
+            == U"a\xFFFD\xFFFD"));
+
+    /// ## Compile time transcoding
+    {
+        using namespace f5::literals;
+        f5::u8string const s{u"Hello \xD83D\xDE03"_u8};
+        assert(s == "Hello \xF0\x9F\x98\x83");
+        assert(not s.is_shared());
+        f5::u8view const v{U"\x2713"_u8};
+        assert(v == "\xE2\x9C\x93");
+    }
+
+    return 0;
+}
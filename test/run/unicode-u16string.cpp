@@ -104,7 +104,7 @@ int main() {
     assert(hw.substr(3) == hw.substr_pos(3, 123));
 
     auto lo = hw.substr_pos(3, 5);
-    assert(lo.shares_allocation_with(hw));
+    assert(lo.is_inline());
     char16_t const *const plo = lo.shrink_to_fit();
     assert(plo[0] == 'l');
     assert(plo[1] == 'o');
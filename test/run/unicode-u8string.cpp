@@ -17,22 +17,58 @@ int main() {
     f5::u8string h{f5::lstring{"Hello"}};
     assert(not h.is_shared());
     f5::u8string hw{std::string{"Hello world"}};
-    assert(hw.is_shared());
+    assert(hw.is_inline());
+    assert(not hw.is_shared());
     const auto ce{e}, ch{h}, chw{hw};
 
     [hw](f5::u8view v) {
-        assert(hw.is_shared());
-        assert(v.is_shared());
+        assert(not v.is_shared());
         assert(v == hw);
-        assert(v.data() == hw.data());
+        /// The captured copy has its own inline storage
+        assert(v.data() != hw.data());
 
         f5::u8string nhw{v};
-        assert(nhw.is_shared());
-        assert(nhw.data() == hw.data());
-        assert(nhw.shares_allocation_with(v));
-        assert(nhw.shares_allocation_with(hw));
+        assert(nhw.is_inline());
+        assert(nhw.data() != hw.data());
     }(hw);
 
+    /// Longer strings share their allocation
+    f5::u8string lw{std::string{"Hello world, from a longer string"}};
+    assert(not lw.is_inline());
+    assert(lw.is_shared());
+    [lw](f5::u8view v) {
+        assert(lw.is_shared());
+        assert(v.is_shared());
+        assert(v == lw);
+        assert(v.data() == lw.data());
+
+        f5::u8string nlw{v};
+        assert(nlw.is_shared());
+        assert(nlw.data() == lw.data());
+        assert(nlw.shares_allocation_with(v));
+        assert(nlw.shares_allocation_with(lw));
+    }(lw);
+    {
+        f5::u8string lwc{lw.begin(), lw.end()};
+        assert(lw == lwc);
+        assert(lw.shares_allocation_with(lwc));
+        f5::u8view lwcc{lwc.begin(), lwc.end()};
+        f5::u8string lwccc{lwcc.begin(), lwcc.end()};
+        assert(lw.shares_allocation_with(lwcc));
+        assert(lw.shares_allocation_with(lwccc));
+        lwccc = f5::u8string{std::string("Next")};
+        assert(lwccc.is_inline());
+        assert(not lw.shares_allocation_with(lwccc));
+        lwccc = lw;
+        assert(lw.shares_allocation_with(lwccc));
+        /// Short substrings are copied inline
+        auto const sub = lw.substr_pos(6, 11);
+        assert(sub == "world");
+        assert(sub.is_inline());
+        auto const tail = lw.substr(6);
+        assert(tail.shares_allocation_with(lw));
+    }
+
     assert(e.empty());
     assert(ce.empty());
 
@@ -45,24 +81,32 @@ int main() {
 
     f5::u8string hwc{hw.begin(), hw.end()};
     assert(hw == hwc);
-    assert(hw.shares_allocation_with(hwc));
+    assert(hwc.is_inline());
     f5::u8view hwcc{hwc.begin(), hwc.end()};
     f5::u8string hwccc{hwcc.begin(), hwcc.end()};
     assert(hw == hwcc);
     assert(hw == hwccc);
-    assert(hw.shares_allocation_with(hwcc));
-    assert(hw.is_shared());
-    assert(hw.shares_allocation_with(hwccc));
     hwccc = f5::u8string{std::string("Next")};
     assert(hwccc == "Next");
-    assert(hw.shares_allocation_with(hwcc));
-    assert(hw.is_shared());
-    assert(not hw.shares_allocation_with(hwccc));
     hwccc = hw;
     assert(hwccc == "Hello world");
-    assert(hw.shares_allocation_with(hwcc));
-    assert(hw.is_shared());
-    assert(hw.shares_allocation_with(hwccc));
+    assert(hwccc.is_inline());
+    assert(hwccc.data() != hw.data());
+    /// Assigning a string to itself leaves it alone
+    {
+        auto &same = hwccc;
+        hwccc = same;
+        assert(hwccc == "Hello world");
+        hwccc = std::move(same);
+        assert(hwccc == "Hello world");
+        assert(hwccc.is_inline());
+        f5::u8string long_string{lw};
+        auto &same_long = long_string;
+        long_string = same_long;
+        long_string = std::move(same_long);
+        assert(long_string == lw);
+        assert(long_string.shares_allocation_with(lw));
+    }
 
     f5::u8string gw{f5::lstring{"Goodbye world"}};
 
@@ -104,7 +148,7 @@ int main() {
     assert(hw.substr(3) == hw.substr_pos(3, 123));
 
     auto lo = hw.substr_pos(3, 5);
-    assert(lo.shares_allocation_with(hw));
+    assert(lo.is_inline());
     char const *const plo = lo.shrink_to_fit();
     assert(plo[0] == 'l');
     assert(plo[1] == 'o');
@@ -0,0 +1,50 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/unicode-string.hpp>
+
+#include <cstring>
+
+
+int main() {
+    char const *const text = "A string that is too long to be stored inline";
+
+    f5::u8string_local const l{f5::u8view_local{text, std::strlen(text)}};
+    assert(l == text);
+    assert(l.is_shared());
+    {
+        auto const c1 = l, c2 = l;
+        assert(c1.shares_allocation_with(l));
+        assert(c2.shares_allocation_with(l));
+        f5::u8view_local const v{c1};
+        assert(v.shares_allocation_with(l));
+        assert(f5::u8string_local{v}.shares_allocation_with(l));
+    }
+    assert(l.substr(2).shares_allocation_with(l));
+    assert(l.substr(2) == text + 2);
+
+    /// Converting copies the code units
+    f5::u8string const a{l};
+    assert(a == text);
+    assert(a.is_shared());
+    assert(a.data() != l.data());
+    f5::u8string_local const b{a};
+    assert(b == text);
+    assert(b.data() != a.data());
+
+    /// Short strings are still inline
+    f5::u8string_local const s{f5::u8string{"Hello"}};
+    assert(s.is_inline());
+    assert(s == "Hello");
+    f5::u8string_local const lit{"Hello world"};
+    assert(not lit.is_shared());
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+/**
+    Copyright 2020 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#include "assert.hpp"
+
+#include <f5/cord/unicode-string.hpp>
+
+#include <string>
+
+
+namespace {
+    std::size_t valid(std::string const &s) {
+        return f5::cord::valid_length(f5::cord::const_u8buffer{s.data(), s.size()});
+    }
+    /// Compare the result of the bulk validation with the scalar code
+    std::size_t scalar(std::string const &s) {
+        return f5::cord::detail::u8valid_length(
+                reinterpret_cast<unsigned char const *>(s.data()), s.size());
+    }
+}
+
+
+int main() {
+    if (not f5::cord::simd::cpu_supported()) return 0;
+
+    /// ## UTF-8
+    assert(f5::cord::validate(f5::u8view{}));
+    assert(f5::cord::validate(""));
+    assert(f5::cord::validate("Hello world"));
+    assert(f5::cord::validate("Hello world \xF0\x9F\x98\x83"));
+    assert(f5::cord::validate("\xC2\x80 \xDF\xBF \xE0\xA0\x80 \xEF\xBF\xBF"));
+    assert(f5::cord::validate("\xF0\x90\x80\x80 \xF4\x8F\xBF\xBF"));
+    assert(f5::cord::validate("\xED\x9F\xBF \xEE\x80\x80"));
+
+    /// Continuation bytes in lead position
+    assert(not f5::cord::validate("\x80"));
+    assert(not f5::cord::validate("abc\xBF"));
+    /// Overlong forms
+    assert(not f5::cord::validate("\xC0\x80"));
+    assert(not f5::cord::validate("\xC1\xBF"));
+    assert(not f5::cord::validate("\xE0\x9F\xBF"));
+    assert(not f5::cord::validate("\xF0\x8F\xBF\xBF"));
+    /// Encoded surrogates
+    assert(not f5::cord::validate("\xED\xA0\x80"));
+    assert(not f5::cord::validate("\xED\xBF\xBF"));
+    /// Beyond U+10FFFF
+    assert(not f5::cord::validate("\xF4\x90\x80\x80"));
+    assert(not f5::cord::validate("\xF5\x80\x80\x80"));
+    assert(not f5::cord::validate("\xFF"));
+    /// Truncated sequences
+    assert(not f5::cord::validate("\xE2\x9C"));
+    assert(not f5::cord::validate("\xF0\x9F\x98"));
+    assert(not f5::cord::validate("\xE2\x9C "));
+    /// Too many continuations
+    assert(not f5::cord::validate("\xC2\x80\x80"));
+
+    assert(valid("abc\xE2\x9C\x93\xE2\x9C") == 6u);
+    assert(valid("abc\xC0\x80") == 3u);
+
+    /// Push the good and bad sequences through every position in a
+    /// block for all of the vector sizes
+    char const *const goods[] = {
+            "\xC3\xA6", "\xE2\x9C\x93", "\xF0\x9F\x98\x83", "\xF4\x8F\xBF\xBF"};
+    char const *const bads[] = {"\x80",         "\xC0\xAF",
+                                "\xE0\x80\xAF", "\xED\xA0\x80",
+                                "\xF4\x90\x80\x80", "\xF8\x88\x80\x80\x80",
+                                "\xE2\x9C"};
+    for (std::size_t prefix{}; prefix < 140u; ++prefix) {
+        for (auto const g : goods) {
+            std::string s(prefix, 'x');
+            s += g;
+            assert(valid(s) == s.size());
+            assert(scalar(s) == s.size());
+            s += std::string(prefix % 67, 'y');
+            assert(valid(s) == s.size());
+            for (auto const b : bads) {
+                std::string e{s.substr(0, prefix)};
+                e += b;
+                e += s.substr(prefix);
+                assert(valid(e) == prefix);
+                assert(scalar(e) == prefix);
+            }
+        }
+    }
+    for (std::size_t length{}; length < 200u; ++length) {
+        std::string s;
+        while (s.size() < length) s += "\xE2\x9C\x93";
+        assert(valid(s) == s.size());
+        std::string t{s, 0, length};
+        assert(valid(t) == scalar(t));
+    }
+
+    /// ## UTF-16 and UTF-32
+    assert(f5::cord::validate(u"Hello world \xD83D\xDE03"));
+    assert(not f5::cord::validate(u"Hello world \xD83D"));
+    assert(not f5::cord::validate(u"Hello world \xDE03\xD83D"));
+    assert(f5::cord::validate(U"Hello world \x1F603"));
+    assert(not f5::cord::validate(U"Hello world \xD83D"));
+    assert(not f5::cord::validate(U"Hello world \x110000"));
+
+    /// ## Checked construction
+    f5::u8string const hw{f5::cord::checked, "Hello world"};
+    assert(hw == "Hello world");
+    f5::u8string const shw{f5::cord::checked, std::string{"Hello world"}};
+    assert(shw == "Hello world");
+    try {
+        f5::u8string{f5::cord::checked, std::string{"\xED\xA0\x80"}};
+        assert(false);
+    } catch (std::range_error &) {}
+    try {
+        f5::u16string{f5::cord::checked, u"\xDE03"};
+        assert(false);
+    } catch (std::range_error &) {}
+
+    return 0;
+}